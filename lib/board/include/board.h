@@ -63,15 +63,80 @@ namespace Board {
         NONE
     };
 
+    // Fixed capacity list of moves, never allocates
+    struct MoveList {
+        std::array<std::pair<int, int>, kBoardSize * kBoardSize> moves;
+        size_t size = 0;
+
+        const std::pair<int, int>* begin() const {
+            return moves.data();
+        }
+
+        const std::pair<int, int>* end() const {
+            return moves.data() + size;
+        }
+
+        bool empty() const {
+            return size == 0U;
+        }
+
+        const std::pair<int, int>& operator[](size_t index) const {
+            return moves[index];
+        }
+    };
+
+    // Board state checks shared by the owning Board and the non-owning BoardView
+    bool isBoardFull(const BoardType& board);
+    bool isPlayerWinner(const BoardType& board, BoardPlayerType player);
+    bool isMoveValid(const BoardType& board, int row, int col);
+    // Empty fields in row major order
+    MoveList legalMoves(const BoardType& board);
+
+    // Non-owning, read-only view of a board state. Cheap to copy, it must not outlive the
+    // board it was created from.
+    class BoardView {
+    public:
+        explicit BoardView(const BoardType& board) : board_(&board) {}
+
+        const BoardType& get_board() const {
+            return *board_;
+        }
+
+        BoardField at(int row, int col) const {
+            return (*board_)[row][col];
+        }
+
+        bool is_full() const {
+            return isBoardFull(*board_);
+        }
+
+        bool is_winner(BoardPlayerType player) const {
+            return isPlayerWinner(*board_, player);
+        }
+
+        bool is_valid_move(int row, int col) const {
+            return isMoveValid(*board_, row, col);
+        }
+
+        MoveList legal_moves() const {
+            return legalMoves(*board_);
+        }
+
+    private:
+        const BoardType* board_;
+    };
+
     class IBoard {
     public:
         virtual ~IBoard() = default;
         virtual BoardType get_board() const = 0;
+        virtual BoardView view() const = 0;
         virtual bool is_full() const = 0;
         virtual bool is_winner(BoardPlayerType player) const = 0;
         virtual bool is_valid_move(int row, int col) const = 0;
         virtual std::expected<bool, BoardError> make_move(int row, int col, BoardPlayerType player) = 0;
         virtual void reset() = 0;
+        virtual void set_board(const BoardType& board) = 0;
 
     };
 
@@ -89,6 +154,11 @@ namespace Board {
             return board_impl_->get_board();
         }
 
+        // View of the current state, valid until the board is destroyed
+        BoardView view() const {
+            return board_impl_->view();
+        }
+
         bool is_full() const {
             return board_impl_->is_full();
         }
@@ -109,6 +179,11 @@ namespace Board {
             board_impl_->reset();
         }
 
+        // Replace the whole state, e.g. when restoring a saved game
+        void set_board(const BoardType& board) {
+            board_impl_->set_board(board);
+        }
+
     private:
         std::unique_ptr<IBoard> board_impl_;
     };
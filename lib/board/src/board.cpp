@@ -6,6 +6,50 @@
 
 namespace Board {
 
+bool isBoardFull(const BoardType& board) {
+    return std::ranges::none_of(board | std::views::join, [](const auto field) {
+        return field == BoardField::EMPTY;
+    });
+}
+
+bool isPlayerWinner(const BoardType& board, BoardPlayerType player) {
+    const auto board_player = convertPlayerTypeToBoardField(player);
+    for (size_t i = 0; i < kBoardSize; ++i) {
+        if (board[i][0] == board_player && board[i][1] == board_player && board[i][2] == board_player) {
+            return true;
+        }
+        if (board[0][i] == board_player && board[1][i] == board_player && board[2][i] == board_player) {
+            return true;
+        }
+    }
+    if (board[0][0] == board_player && board[1][1] == board_player && board[2][2] == board_player) {
+        return true;
+    }
+    if (board[0][2] == board_player && board[1][1] == board_player && board[2][0] == board_player) {
+        return true;
+    }
+    return false;
+}
+
+bool isMoveValid(const BoardType& board, int row, int col) {
+    if (row < 0 || row >= static_cast<int>(kBoardSize) || col < 0 || col >= static_cast<int>(kBoardSize)) {
+        return false;
+    }
+    return board[row][col] == BoardField::EMPTY;
+}
+
+MoveList legalMoves(const BoardType& board) {
+    MoveList list;
+    for (int row = 0; row < static_cast<int>(kBoardSize); ++row) {
+        for (int col = 0; col < static_cast<int>(kBoardSize); ++col) {
+            if (board[row][col] == BoardField::EMPTY) {
+                list.moves[list.size++] = {row, col};
+            }
+        }
+    }
+    return list;
+}
+
 class BoardImpl : public IBoard{
 public:
     BoardImpl() {
@@ -21,36 +65,20 @@ public:
         return board_;
     }
 
+    BoardView view() const override {
+        return BoardView(board_);
+    }
+
     bool is_full() const override {
-        return std::ranges::none_of(board_ | std::views::join, [](const auto field) {
-            return field == BoardField::EMPTY;
-        });
+        return isBoardFull(board_);
     }
 
     bool is_winner(BoardPlayerType player) const override {
-        const auto board_player = convertPlayerTypeToBoardField(player);
-        for (size_t i = 0; i < kBoardSize; ++i) {
-            if (board_[i][0] == board_player && board_[i][1] == board_player && board_[i][2] == board_player) {
-                return true;
-            }
-            if (board_[0][i] == board_player && board_[1][i] == board_player && board_[2][i] == board_player) {
-                return true;
-            }
-        }
-        if (board_[0][0] == board_player && board_[1][1] == board_player && board_[2][2] == board_player) {
-            return true;
-        }
-        if (board_[0][2] == board_player && board_[1][1] == board_player && board_[2][0] == board_player) {
-            return true;
-        }
-        return false;
+        return isPlayerWinner(board_, player);
     }
 
     bool is_valid_move(int row, int col) const override {
-        if (row < 0 || row >= static_cast<int>(kBoardSize) || col < 0 || col >= static_cast<int>(kBoardSize)) {
-            return false;
-        }
-        return board_[row][col] == BoardField::EMPTY;
+        return isMoveValid(board_, row, col);
     }
 
     std::expected<bool, BoardError> make_move(int row, int col, BoardPlayerType player) override {
@@ -71,7 +99,15 @@ public:
         std::ranges::fill(flat_view, BoardField::EMPTY);
     }
 
+    void set_board(const BoardType& board) override {
+        board_ = board;
+    }
+
     void print_board() const {
+        // Called for every move of the bot search, only build the text when it is written
+        if (!LOG_ENABLED(debug)) {
+            return;
+        }
         std::stringstream  board_str = {};
         for (const auto& row : board_) {
             for (const auto& field : row) {
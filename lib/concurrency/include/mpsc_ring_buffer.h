@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace Concurrency {
+
+// Bounded lock-free multi-producer single-consumer queue (per-slot sequence numbers, as in
+// D. Vyukov's bounded MPMC queue). push() and pop() block on std::atomic::wait while the queue
+// is full or empty, so a full queue slows the producers down instead of dropping items.
+// A thread which both produces and consumes must use tryPush() to avoid waiting on itself.
+template <typename T, size_t Capacity>
+class MpscRingBuffer {
+    static_assert(Capacity >= 2U && std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+public:
+    MpscRingBuffer() {
+        for (size_t index = 0; index < Capacity; ++index) {
+            slots_[index].sequence.store(index, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer &) = delete;
+    MpscRingBuffer &operator=(const MpscRingBuffer &) = delete;
+
+    // Returns false when the queue is full, the value is left untouched then
+    bool tryPush(const T &value) {
+        return tryEmplace(value);
+    }
+
+    bool tryPush(T &&value) {
+        return tryEmplace(std::move(value));
+    }
+
+    // The arguments are only used once a slot is claimed, so a full queue leaves them untouched
+    template <typename... Args>
+    bool tryEmplace(Args &&...args) {
+        auto position = tail_.load(std::memory_order_relaxed);
+        Slot *slot = nullptr;
+        while (true) {
+            slot = &slots_[position & kIndexMask];
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = T(std::forward<Args>(args)...);
+        slot->sequence.store(position + 1U, std::memory_order_release);
+        pushed_.fetch_add(1U, std::memory_order_release);
+        pushed_.notify_one();
+        return true;
+    }
+
+    // Blocks while the queue is full
+    void push(const T &value) {
+        emplace(value);
+    }
+
+    void push(T &&value) {
+        emplace(std::move(value));
+    }
+
+    template <typename... Args>
+    void emplace(Args &&...args) {
+        while (true) {
+            const auto popped = popped_.load(std::memory_order_acquire);
+            // Forwarding again after a failed attempt is safe, tryEmplace() did not consume the arguments
+            if (tryEmplace(std::forward<Args>(args)...)) {
+                return;
+            }
+            popped_.wait(popped, std::memory_order_acquire);
+        }
+    }
+
+    // Consumer only
+    std::optional<T> tryPop() {
+        auto &slot = slots_[head_ & kIndexMask];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(head_ + 1U) < 0) {
+            return std::nullopt;
+        }
+        auto value = std::move(slot.value);
+        slot.sequence.store(head_ + Capacity, std::memory_order_release);
+        ++head_;
+        popped_.fetch_add(1U, std::memory_order_release);
+        popped_.notify_all();
+        return value;
+    }
+
+    // Consumer only, blocks while the queue is empty
+    T pop() {
+        while (true) {
+            const auto pushed = pushed_.load(std::memory_order_acquire);
+            if (auto value = tryPop()) {
+                return std::move(*value);
+            }
+            pushed_.wait(pushed, std::memory_order_acquire);
+        }
+    }
+
+private:
+    static constexpr size_t kIndexMask = Capacity - 1U;
+    static constexpr size_t kCacheLineSize = 64U;
+
+    struct alignas(kCacheLineSize) Slot {
+        std::atomic<size_t> sequence;
+        T value {};
+    };
+
+    alignas(kCacheLineSize) std::atomic<size_t> tail_ = 0;
+    alignas(kCacheLineSize) size_t head_ = 0;
+    // Wait/notify words, bumped after every push and pop
+    alignas(kCacheLineSize) std::atomic<uint32_t> pushed_ = 0;
+    alignas(kCacheLineSize) std::atomic<uint32_t> popped_ = 0;
+    Slot slots_[Capacity];
+};
+
+} // namespace Concurrency
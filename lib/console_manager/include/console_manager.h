@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "board.h"
@@ -21,7 +22,13 @@ public:
     virtual void clearConsole() = 0;
     virtual void pauseConsole() = 0;
     virtual void gameEndMessage() = 0;
-    virtual std::pair<int, int> getPlayerMove(const Board::BoardType& board) = 0;
+    // Reads keys until a move is confirmed. Returns nullopt when woken by wake() or interrupt(),
+    // the next call continues the same selection. Throws std::runtime_error on ESC or closed input.
+    virtual std::optional<std::pair<int, int>> getPlayerMove(const Board::BoardType& board) = 0;
+    // Makes a waiting getPlayerMove() return, thread safe
+    virtual void wake() = 0;
+    // Like wake(), also ends pauseConsole() and all further getPlayerMove() calls
+    virtual void interrupt() = 0;
 };
 
 class ConsoleManager : public IConsoleManager {
@@ -53,10 +60,18 @@ public:
         impl_->gameEndMessage();
     }
 
-    std::pair<int, int> getPlayerMove(const Board::BoardType& board) override {
+    std::optional<std::pair<int, int>> getPlayerMove(const Board::BoardType& board) override {
         return impl_->getPlayerMove(board);
     }
 
+    void wake() override {
+        impl_->wake();
+    }
+
+    void interrupt() override {
+        impl_->interrupt();
+    }
+
 private:
     std::unique_ptr<IConsoleManager> impl_;
 };
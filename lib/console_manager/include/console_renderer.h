@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Character grid composed in memory and drawn incrementally. Callers edit the back buffer,
+// present() compares it with the frame on screen and sends only the changed runs, each behind a
+// cursor positioning escape, in a single write(). Rows and columns are 0 based.
+class ConsoleRenderer {
+public:
+    struct Position {
+        size_t row;
+        size_t col;
+    };
+
+    explicit ConsoleRenderer(int fd);
+
+    // Replace a whole line
+    void setLine(size_t row, std::string_view text);
+    // Overwrite part of a line, the line grows as needed
+    void put(size_t row, size_t col, std::string_view text);
+    void clearLine(size_t row);
+    // Empty the back buffer, the screen changes only on the next present()
+    void clear();
+    // The screen no longer matches the last frame (e.g. something else printed), redraw all of it
+    void invalidate();
+    // Draw the difference and leave the cursor at cursor, or after the last row
+    void present(std::optional<Position> cursor = std::nullopt);
+
+    size_t rows() const {
+        return back_.size();
+    }
+
+    // Bytes of the last present(), for diagnostics
+    size_t lastFrameBytes() const {
+        return output_.size();
+    }
+
+private:
+    int fd_;
+    std::vector<std::string> front_;
+    std::vector<std::string> back_;
+    std::string output_;
+    bool full_redraw_ = true;
+
+    void moveTo(size_t row, size_t col);
+    void diffLine(size_t row, const std::string &prev, const std::string &next);
+    void writeOutput();
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class KeyType {
+    Character,
+    Enter,
+    Escape,
+    ArrowUp,
+    ArrowDown,
+    ArrowLeft,
+    ArrowRight,
+    Unknown     // a complete escape sequence nobody handles, e.g. a function key
+};
+
+struct Key {
+    KeyType type = KeyType::Unknown;
+    char character = 0;     // for KeyType::Character
+};
+
+enum class InputStatus {
+    Key,
+    Woken,      // wake() was called
+    Closed      // end of input
+};
+
+struct InputEvent {
+    InputStatus status;
+    Key key;
+};
+
+// Owns the terminal for the lifetime of the object: raw mode (no line buffering, no echo,
+// signals still work) is entered once and restored on destruction, at exit and on fatal signals.
+// waitForInput() polls stdin together with an eventfd, so other threads can wake the waiting
+// reader through wake() instead of waiting for a key press. Stdin which is not a terminal is
+// read as is. Only one session may exist at a time.
+class TerminalSession {
+public:
+    TerminalSession();
+    ~TerminalSession();
+    TerminalSession(const TerminalSession &) = delete;
+    TerminalSession &operator=(const TerminalSession &) = delete;
+
+    // Blocks until a whole key is decoded, wake() was called or stdin is closed
+    InputEvent waitForInput();
+    // Thread and async signal safe
+    void wake();
+
+    bool isRaw() const {
+        return raw_;
+    }
+
+private:
+    int wake_fd_ = -1;
+    bool raw_ = false;
+    bool closed_ = false;
+    std::array<uint8_t, 64> input_ {};
+    size_t input_begin_ = 0;
+    size_t input_end_ = 0;
+
+    // Reads what stdin has within timeout_ms (-1 waits), false when woken or closed
+    bool fill(int timeout_ms, bool &woken);
+    bool decode(Key &key, bool more_may_follow);
+};
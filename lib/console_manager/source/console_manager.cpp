@@ -1,31 +1,45 @@
 #include "console_manager.h"
+#include "console_renderer.h"
+#include "terminal_session.h"
 
 #include <log.h>
 
-#include <iostream>
-#include <string_view>
 #include <algorithm>
-
-// Platform-specific includes for input handling
-#ifdef _WIN32
-#include <conio.h>
-#else
-#include <termios.h>
-#include <unistd.h>
-#include <stdio.h>
-#endif
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 // #define DISABLE_CONSOLE_CLEAR
 
-constexpr char kEscKey = 27; // ESC key
-constexpr char kExtendedKeyArrowUp = 72;
-constexpr char kExtendedKeyArrowDown = 80;
-constexpr char kExtendedKeyArrowLeft = 75;
-constexpr char kExtendedKeyArrowRight = 77;
+// Screen layout, the board fills rows kBoardTopRow .. kBoardTopRow + 2 * size - 2
+constexpr size_t kStatsRow = 0U;
+constexpr size_t kBoardTopRow = 1U;
+constexpr size_t kCellWidth = 5U;      // " X " and the "||" separator
+constexpr size_t kCellHeight = 2U;     // cells and the "=====" separator line
+
+constexpr size_t boardRows(size_t board_size) {
+    return kCellHeight * board_size - 1U;
+}
+
+// Rows below the board
+constexpr size_t instructionsRow(size_t board_size) {
+    return kBoardTopRow + boardRows(board_size) + 1U;
+}
+
+constexpr size_t messageRow(size_t board_size) {
+    return instructionsRow(board_size) + 2U;
+}
+
+constexpr size_t promptRow(size_t board_size) {
+    return messageRow(board_size) + 1U;
+}
 
 class ConsoleManagerImpl : public IConsoleManager {
 public:
-    ConsoleManagerImpl() {
+    ConsoleManagerImpl() : renderer_(fileno(stdout)) {
         LOG_D("Console Manager created\n");
     }
 
@@ -33,106 +47,97 @@ public:
         LOG_D("Console Manager destroyed\n");
     }
 
-    int getKey() {
-#ifdef _WIN32
-        return _getch();
-#else
-        struct termios oldt, newt;
-        int ch;
-        tcgetattr(STDIN_FILENO, &oldt);
-        newt = oldt;
-        newt.c_lflag &= ~(ICANON | ECHO);
-        tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-        ch = getchar();
-        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-        return ch;
-#endif
-    }
-
     void clearConsole() override {
     #ifndef DISABLE_CONSOLE_CLEAR
-        // ANSI escape code for clearing screen
-        std::cout << "\033[2J\033[1;1H";
+        renderer_.clear();
+        renderer_.invalidate();
+        renderer_.present();
     #endif
     }
 
     void pauseConsole() override {
-        std::cout << "Press any key to continue..." << std::endl;
-        getKey();
+        const auto row = std::max(promptRow(board_size_), renderer_.rows());
+        renderer_.setLine(row, "Press any key to continue...");
+        renderer_.present();
+        // Events arriving meanwhile wait for the key, only interrupt() cuts the pause short
+        while (!interrupted_.load(std::memory_order_acquire)) {
+            const auto input = terminal_.waitForInput();
+            if (input.status != InputStatus::Woken) {
+                break;
+            }
+        }
+        renderer_.clearLine(row);
     }
 
     void printBoard(const Board::BoardType& board) override {
-        constexpr std::string_view kCellContent =       " ";
-        constexpr std::string_view kColumnSeparator =   "||";
-        constexpr std::string_view kEdgeSeparator =     "====";
-        constexpr std::string_view kMiddleSeparator =   "=====";
-
-        for (const auto &row : board) {
-            for (const auto &cell : row) {
-                const auto cell_char = Board::convertBoardFieldToChar(cell);
-                std::cout << kCellContent << cell_char << kCellContent;
-                if (&cell != &row.back()) {
-                    std::cout << kColumnSeparator;
-                }
-            }
-            if (&row != &board.back()) {
-                std::cout << std::endl << kEdgeSeparator;
-                for (size_t sep = 0; sep < board.size() - 2; ++sep) {
-                    std::cout << kMiddleSeparator;
-                }
-                std::cout << kEdgeSeparator;
-            }
-            std::cout << std::endl;
-        }
-        std::cout << std::endl << std::endl;
+        drawBoard(board);
+        renderer_.present();
     }
 
     void printGameStats(int host_score, int guest_score, size_t round) override {
-        std::cout << "Round: " << round << " Host Score: " << host_score
-                  << " Guest Score: " << guest_score << std::endl;
+        renderer_.setLine(kStatsRow, "Round: " + std::to_string(round) + " Host Score: " + std::to_string(host_score) +
+                                     " Guest Score: " + std::to_string(guest_score));
+        renderer_.present();
     }
 
     void printRoundEndMessage(const Board::BoardType& board, RoundResult result, size_t round) override {
-        clearConsole();
-        printBoard(board);
-        std::cout << "Round " << round << " ended. Result: ";
+        drawBoard(board);
+        renderer_.clearLine(instructionsRow(board_size_));
+        renderer_.clearLine(instructionsRow(board_size_) + 1U);
+        std::string message = "Round " + std::to_string(round) + " ended. Result: ";
         switch (result) {
             case RoundResult::HostWin:
-                std::cout << "Host wins!\n";
+                message += "Host wins!";
                 break;
             case RoundResult::GuestWin:
-                std::cout << "Guest wins!\n";
+                message += "Guest wins!";
                 break;
             case RoundResult::Draw:
-                std::cout << "It's a draw!\n";
+                message += "It's a draw!";
                 break;
             default:
-                std::cout << "Unknown result!\n";
+                message += "Unknown result!";
                 break;
         }
+        renderer_.setLine(messageRow(board_size_), message);
         pauseConsole();
+        renderer_.clearLine(messageRow(board_size_));
     }
 
     void gameEndMessage() override {
-
-        std::cout << "\nThank you for game!" << std::endl;
+        const auto row = renderer_.rows() + 1U;
+        renderer_.setLine(row, "Thank you for game!");
+        renderer_.present();
         pauseConsole();
-        std::cout << "Goodbye!\n";
+        renderer_.setLine(renderer_.rows(), "Goodbye!");
+        renderer_.present();
+    }
+
+    void wake() override {
+        terminal_.wake();
     }
 
-    std::pair<int, int> getPlayerMove(const Board::BoardType& board) override {
+    void interrupt() override {
+        interrupted_.store(true, std::memory_order_release);
+        terminal_.wake();
+    }
+
+    std::optional<std::pair<int, int>> getPlayerMove(const Board::BoardType& board) override {
         Board::Board board_copy {board};
-        constexpr int kCellWidth = 5;
-        constexpr int kCellHeight = 2;
         constexpr char kPlayerSymbol = 'X';
         const int kBoardSize = static_cast<int>(board.size());
+        const auto message_row = messageRow(board.size());
 
-        int current_col = 0;
-        int current_row = 0;
+        // The cursor stays where it was when the last call was woken
+        if (!move_in_progress_) {
+            cursor_ = {0, 0};
+            move_in_progress_ = true;
+        }
+        auto &[current_row, current_col] = cursor_;
 
-        printBoard(board);
-        std::cout << "\nInstructions: Use W/A/S/D to move, Enter to confirm\n"
-                  << "Press ESC to exit" << std::endl;
+        drawBoard(board);
+        renderer_.setLine(instructionsRow(board.size()), "Instructions: Use W/A/S/D to move, Enter to confirm");
+        renderer_.setLine(instructionsRow(board.size()) + 1U, "Press ESC to exit");
 
         auto move_up = [](int &row) {
             row = (std::max)(row - 1, 0);
@@ -146,112 +151,127 @@ public:
         auto move_right = [](int &col, int max_col) {
             col = (std::min)(col + 1, max_col - 1);
         };
+        auto show_message = [&](std::string_view message) {
+            renderer_.setLine(message_row, message);
+        };
+        auto exit_game = [&]() {
+            move_in_progress_ = false;
+            show_message("Game interrupted by user. Exiting...");
+            renderer_.present();
+            throw std::runtime_error("Game interrupted by user.");
+        };
 
-        while (true) {
-            // Calculate cursor position using ANSI escape codes
-            int cursor_x = current_col * kCellWidth + 1;
-            int cursor_y = current_row * kCellHeight + 1;
-            std::cout << "\033[" << (cursor_y + 1) << ";" << (cursor_x + 1) << "H" << std::flush;
-
-            // Handle input with cross-platform key detection
-            int input = getKey();
-            int extended_input = 0;
-
-            // Process escape sequences for arrow keys
-            if (input == kEscKey) { // ESC character
-                // Check for immediate follow-up characters (non-blocking)
-#ifdef _WIN32
-                if (!_kbhit()) {  // Windows: check if key is available
-#else
-                // Unix: check input availability with select()
-                struct timeval tv = {0, 0};
-                fd_set fds;
-                FD_ZERO(&fds);
-                FD_SET(STDIN_FILENO, &fds);
-                if (select(1, &fds, NULL, NULL, &tv) == 0) {  // No data available
-#endif
-                    // Handle standalone ESC immediately
-                    std::cout << "Game interrupted by user. Exiting...\n";
-                    throw std::runtime_error("Game interrupted by user.");
-                }
+        while (!interrupted_.load(std::memory_order_acquire)) {
+            // Only the changes since the last key press and the cursor position are sent
+            renderer_.present(cellPosition(current_row, current_col));
 
-                int next = getKey();
-                if (next == '[') { // CSI sequence
-                    int code = getKey();
-                    switch (code) {
-                        case 'A': extended_input = kExtendedKeyArrowUp; break;
-                        case 'B': extended_input = kExtendedKeyArrowDown; break;
-                        case 'C': extended_input = kExtendedKeyArrowRight; break;
-                        case 'D': extended_input = kExtendedKeyArrowLeft; break;
-                        default: break;
-                    }
-                    input = 0xE0; // Simulate Windows extended key
-                }
-            } else if (input == 0x00 || input == 0xE0) { // Extended key prefix
-                extended_input = getKey();
+            const auto input = terminal_.waitForInput();
+            if (input.status == InputStatus::Woken) {
+                return std::nullopt;
             }
+            if (input.status == InputStatus::Closed) {
+                exit_game();
+            }
+            renderer_.clearLine(message_row);
 
-            // Calculate message position
-            int message_y = kCellHeight * kBoardSize + 2;
-            std::cout << "\033[" << (message_y + 1) << ";1H" << std::flush;
-
-            switch (std::tolower(input)) {
-                case kEscKey: // ESC key
-                if (extended_input == 0) {
-                    std::cout << "Game interrupted by user. Exiting...\n";
-                    throw std::runtime_error("Game interrupted by user.");
-                }
-                [[fallthrough]];
-                case 0x00: // Extended key
-                case 0xE0: // Extended key
-                    switch (extended_input) {
-                        case kExtendedKeyArrowUp:
-                            move_up(current_row);
-                            break;
-                        case kExtendedKeyArrowDown:
-                            move_down(current_row, kBoardSize);
-                            break;
-                        case kExtendedKeyArrowLeft:
-                            move_left(current_col);
-                            break;
-                        case kExtendedKeyArrowRight:
-                            move_right(current_col, kBoardSize);
-                            break;
-                        default:
-                            std::cout << "Unknown command. Use W/A/S/D to move.        ";
-                            break;
-                    }
+            switch (input.key.type) {
+                case KeyType::Escape:
+                    exit_game();
                     break;
-                case 'w':
+                case KeyType::ArrowUp:
                     move_up(current_row);
                     break;
-                case 'a':
-                    move_left(current_col);
-                    break;
-                case 's':
+                case KeyType::ArrowDown:
                     move_down(current_row, kBoardSize);
                     break;
-                case 'd':
+                case KeyType::ArrowLeft:
+                    move_left(current_col);
+                    break;
+                case KeyType::ArrowRight:
                     move_right(current_col, kBoardSize);
                     break;
-                    case '\n':  // Linux support
-                    case '\r': { // Enter key
+                case KeyType::Enter:
                     if (board_copy.is_valid_move(current_row, current_col)) {
-                        std::cout << "\033[" << (cursor_y + 1) << ";" << (cursor_x + 1)
-                                  << "H" << kPlayerSymbol << std::flush;
-                        std::cout << "\033[" << (message_y + 1) << ";1H" << "Move confirmed.                              " << std::flush;
+                        const auto cell = cellPosition(current_row, current_col);
+                        renderer_.put(cell.row, cell.col, std::string_view(&kPlayerSymbol, 1U));
+                        show_message("Move confirmed.");
+                        renderer_.present(cell);
+                        move_in_progress_ = false;
                         return std::make_pair(current_row, current_col);
                     }
-                    std::cout << "Position occupied! Choose another location.    ";
+                    show_message("Position occupied! Choose another location.");
+                    break;
+                case KeyType::Character:
+                    switch (std::tolower(static_cast<unsigned char>(input.key.character))) {
+                        case 'w':
+                            move_up(current_row);
+                            break;
+                        case 'a':
+                            move_left(current_col);
+                            break;
+                        case 's':
+                            move_down(current_row, kBoardSize);
+                            break;
+                        case 'd':
+                            move_right(current_col, kBoardSize);
+                            break;
+                        default:
+                            show_message("Unknown command. Use W/A/S/D to move.");
+                            break;
+                    }
                     break;
-                }
                 default:
-                    std::cout << "Unknown command. Use W/A/S/D to move.        ";
+                    show_message("Unknown command. Use W/A/S/D to move.");
                     break;
             }
         }
+        move_in_progress_ = false;
+        return std::nullopt;
     }
 
+private:
+    ConsoleRenderer renderer_;
+    TerminalSession terminal_;
+    std::atomic<bool> interrupted_ = false;
+    // Move selection survives a wake-up, see getPlayerMove()
+    bool move_in_progress_ = false;
+    std::pair<int, int> cursor_ = {0, 0};
+    size_t board_size_ = Board::kBoardSize;
+
+    static ConsoleRenderer::Position cellPosition(int row, int col) {
+        return {kBoardTopRow + static_cast<size_t>(row) * kCellHeight, static_cast<size_t>(col) * kCellWidth + 1U};
+    }
+
+    // Board into the back buffer, drawn by the next present()
+    void drawBoard(const Board::BoardType& board) {
+        constexpr std::string_view kCellContent =       " ";
+        constexpr std::string_view kColumnSeparator =   "||";
+        constexpr std::string_view kEdgeSeparator =     "====";
+        constexpr std::string_view kMiddleSeparator =   "=====";
+
+        board_size_ = board.size();
+        std::string line;
+        for (size_t row = 0; row < board.size(); ++row) {
+            line.clear();
+            for (size_t col = 0; col < board[row].size(); ++col) {
+                line += kCellContent;
+                line += Board::convertBoardFieldToChar(board[row][col]);
+                line += kCellContent;
+                if (col + 1U != board[row].size()) {
+                    line += kColumnSeparator;
+                }
+            }
+            renderer_.setLine(kBoardTopRow + row * kCellHeight, line);
+            if (row + 1U != board.size()) {
+                line.assign(kEdgeSeparator);
+                for (size_t sep = 0; sep < board.size() - 2; ++sep) {
+                    line += kMiddleSeparator;
+                }
+                line += kEdgeSeparator;
+                renderer_.setLine(kBoardTopRow + row * kCellHeight + 1U, line);
+            }
+        }
+    }
 };
 
 ConsoleManager::ConsoleManager() :
@@ -0,0 +1,146 @@
+#include "console_renderer.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Unchanged cells shorter than a cursor escape are rewritten instead of skipped
+constexpr size_t kMaxSkippedCells = 6U;
+
+char cellAt(const std::string &line, size_t col) {
+    return col < line.size() ? line[col] : ' ';
+}
+
+} // namespace
+
+ConsoleRenderer::ConsoleRenderer(int fd) : fd_(fd) {
+}
+
+void ConsoleRenderer::setLine(size_t row, std::string_view text) {
+    if (row >= back_.size()) {
+        back_.resize(row + 1U);
+    }
+    back_[row].assign(text);
+}
+
+void ConsoleRenderer::put(size_t row, size_t col, std::string_view text) {
+    if (row >= back_.size()) {
+        back_.resize(row + 1U);
+    }
+    auto &line = back_[row];
+    if (line.size() < col + text.size()) {
+        line.resize(col + text.size(), ' ');
+    }
+    line.replace(col, text.size(), text);
+}
+
+void ConsoleRenderer::clearLine(size_t row) {
+    if (row < back_.size()) {
+        back_[row].clear();
+    }
+}
+
+void ConsoleRenderer::clear() {
+    back_.clear();
+}
+
+void ConsoleRenderer::invalidate() {
+    full_redraw_ = true;
+}
+
+void ConsoleRenderer::present(std::optional<Position> cursor) {
+    output_.clear();
+    if (full_redraw_) {
+        // Anything still buffered by stdio would land in the middle of the new frame
+        std::fflush(stdout);
+        output_ += "\033[2J";
+        front_.clear();
+        full_redraw_ = false;
+    }
+    static const std::string kEmpty;
+    const auto rows = std::max(front_.size(), back_.size());
+    for (size_t row = 0; row < rows; ++row) {
+        const auto &prev = row < front_.size() ? front_[row] : kEmpty;
+        const auto &next = row < back_.size() ? back_[row] : kEmpty;
+        if (prev != next) {
+            diffLine(row, prev, next);
+        }
+    }
+    front_ = back_;
+    // Without an explicit position the cursor rests below the frame, where plain output continues
+    const auto position = cursor.value_or(Position{back_.size(), 0U});
+    moveTo(position.row, position.col);
+    writeOutput();
+}
+
+void ConsoleRenderer::moveTo(size_t row, size_t col) {
+    output_ += "\033[";
+    output_ += std::to_string(row + 1U);
+    output_ += ';';
+    output_ += std::to_string(col + 1U);
+    output_ += 'H';
+}
+
+void ConsoleRenderer::diffLine(size_t row, const std::string &prev, const std::string &next) {
+    const auto width = std::max(prev.size(), next.size());
+    size_t col = 0;
+    while (col < width) {
+        if (cellAt(prev, col) == cellAt(next, col)) {
+            ++col;
+            continue;
+        }
+        // Extend the run over short stretches of unchanged cells
+        const auto start = col;
+        auto end = col + 1U;
+        for (size_t skipped = 0, probe = end; probe < width && skipped <= kMaxSkippedCells; ++probe) {
+            if (cellAt(prev, probe) != cellAt(next, probe)) {
+                end = probe + 1U;
+                skipped = 0;
+            } else {
+                ++skipped;
+            }
+        }
+        moveTo(row, start);
+        if (end >= next.size() && prev.size() > next.size()) {
+            // The rest of the line only has to be blanked
+            if (start < next.size()) {
+                output_.append(next, start, next.size() - start);
+            }
+            output_ += "\033[K";
+            return;
+        }
+        for (auto cell = start; cell < end; ++cell) {
+            output_ += cellAt(next, cell);
+        }
+        col = end;
+    }
+}
+
+void ConsoleRenderer::writeOutput() {
+    size_t written = 0;
+    while (written < output_.size()) {
+#ifdef _WIN32
+        const auto result = ::_write(fd_, output_.data() + written, static_cast<unsigned>(output_.size() - written));
+#else
+        const auto result = ::write(fd_, output_.data() + written, output_.size() - written);
+#endif
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_E("Console write failed: {}", std::strerror(errno));
+            return;
+        }
+        written += static_cast<size_t>(result);
+    }
+}
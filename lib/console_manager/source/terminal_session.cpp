@@ -0,0 +1,228 @@
+#include "terminal_session.h"
+#include "log.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <csignal>
+#include <cstdlib>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint8_t kEsc = 27U;
+
+#ifndef _WIN32
+// Time for the rest of an escape sequence to arrive before a lone ESC counts as the Escape key
+constexpr int kEscapeTimeoutMs = 30;
+
+constexpr std::array<int, 4> kRestoreSignals = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+
+// Process wide, the signal handlers and atexit() need it without an object
+termios g_saved_termios {};
+std::atomic<bool> g_restore_needed = false;
+std::array<struct sigaction, kRestoreSignals.size()> g_previous_actions {};
+
+void restoreTerminal() {
+    if (g_restore_needed.exchange(false)) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &g_saved_termios);
+    }
+}
+
+extern "C" void restoreTerminalOnSignal(int signal_number) {
+    restoreTerminal();
+    // SA_RESETHAND put the default action back, deliver the signal again to get it
+    raise(signal_number);
+}
+#endif
+
+} // namespace
+
+#ifdef _WIN32
+
+TerminalSession::TerminalSession() = default;
+
+TerminalSession::~TerminalSession() = default;
+
+// The console has no pollable handle to pair with an event, so keys are simply read
+InputEvent TerminalSession::waitForInput() {
+    const int input = _getch();
+    if (input == 0x00 || input == 0xE0) {
+        switch (_getch()) {
+            case 72: return {InputStatus::Key, {KeyType::ArrowUp}};
+            case 80: return {InputStatus::Key, {KeyType::ArrowDown}};
+            case 75: return {InputStatus::Key, {KeyType::ArrowLeft}};
+            case 77: return {InputStatus::Key, {KeyType::ArrowRight}};
+            default: return {InputStatus::Key, {KeyType::Unknown}};
+        }
+    }
+    if (input == kEsc) {
+        return {InputStatus::Key, {KeyType::Escape}};
+    }
+    if (input == '\r' || input == '\n') {
+        return {InputStatus::Key, {KeyType::Enter}};
+    }
+    return {InputStatus::Key, {KeyType::Character, static_cast<char>(input)}};
+}
+
+void TerminalSession::wake() {
+}
+
+#else
+
+TerminalSession::TerminalSession() {
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ < 0) {
+        LOG_E("Terminal eventfd failed: {}", std::strerror(errno));
+        throw std::runtime_error("Terminal eventfd failed");
+    }
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &g_saved_termios) != 0) {
+        LOG_D("Stdin is not a terminal, reading it as is");
+        return;
+    }
+    static const bool exit_handler_registered = std::atexit(restoreTerminal) == 0;
+    std::ignore = exit_handler_registered;
+
+    struct sigaction action {};
+    action.sa_handler = restoreTerminalOnSignal;
+    action.sa_flags = SA_RESETHAND;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < kRestoreSignals.size(); ++i) {
+        sigaction(kRestoreSignals[i], &action, &g_previous_actions[i]);
+    }
+
+    // Keys arrive one by one without echo, Ctrl+C still raises SIGINT
+    termios raw = g_saved_termios;
+    raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    g_restore_needed = true;
+    raw_ = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+    LOG_D("Terminal raw mode {}", raw_ ? "entered" : "failed");
+}
+
+TerminalSession::~TerminalSession() {
+    if (raw_) {
+        restoreTerminal();
+        for (size_t i = 0; i < kRestoreSignals.size(); ++i) {
+            sigaction(kRestoreSignals[i], &g_previous_actions[i], nullptr);
+        }
+    }
+    close(wake_fd_);
+}
+
+InputEvent TerminalSession::waitForInput() {
+    while (true) {
+        Key key;
+        if (decode(key, true)) {
+            return {InputStatus::Key, key};
+        }
+        const bool partial = input_begin_ != input_end_;
+        if (closed_ && !partial) {
+            return {InputStatus::Closed, {}};
+        }
+        bool woken = false;
+        if (closed_ || !fill(partial ? kEscapeTimeoutMs : -1, woken)) {
+            if (woken) {
+                return {InputStatus::Woken, {}};
+            }
+            // Nothing more came, take the partial sequence as it is
+            if (decode(key, false)) {
+                return {InputStatus::Key, key};
+            }
+        }
+    }
+}
+
+void TerminalSession::wake() {
+    const uint64_t value = 1;
+    std::ignore = write(wake_fd_, &value, sizeof(value));
+}
+
+bool TerminalSession::fill(int timeout_ms, bool &woken) {
+    if (input_begin_ > 0U) {
+        std::memmove(input_.data(), input_.data() + input_begin_, input_end_ - input_begin_);
+        input_end_ -= input_begin_;
+        input_begin_ = 0;
+    }
+    std::array<pollfd, 2> fds = {{{STDIN_FILENO, POLLIN, 0}, {wake_fd_, POLLIN, 0}}};
+    const int ready = poll(fds.data(), fds.size(), timeout_ms);
+    if (ready <= 0) {
+        return false;
+    }
+    if ((fds[1].revents & POLLIN) != 0) {
+        uint64_t value = 0;
+        std::ignore = read(wake_fd_, &value, sizeof(value));
+        woken = true;
+        return false;
+    }
+    const auto received = read(STDIN_FILENO, input_.data() + input_end_, input_.size() - input_end_);
+    if (received < 0 && errno == EINTR) {
+        return true;
+    }
+    if (received <= 0) {
+        closed_ = true;
+        return false;
+    }
+    input_end_ += static_cast<size_t>(received);
+    return true;
+}
+
+#endif
+
+// ESC [ or ESC O starts a sequence which ends with a byte in 0x40..0x7E, A to D are the arrows.
+// A lone ESC is the Escape key once no sequence follows it.
+bool TerminalSession::decode(Key &key, bool more_may_follow) {
+    if (input_begin_ == input_end_) {
+        return false;
+    }
+    const auto first = input_[input_begin_];
+    if (first != kEsc) {
+        ++input_begin_;
+        if (first == '\r' || first == '\n') {
+            key = {KeyType::Enter};
+        } else {
+            key = {KeyType::Character, static_cast<char>(first)};
+        }
+        return true;
+    }
+    if (input_end_ - input_begin_ == 1U || (input_[input_begin_ + 1U] != '[' && input_[input_begin_ + 1U] != 'O')) {
+        if (input_end_ - input_begin_ == 1U && more_may_follow) {
+            return false;
+        }
+        ++input_begin_;
+        key = {KeyType::Escape};
+        return true;
+    }
+    for (auto position = input_begin_ + 2U; position < input_end_; ++position) {
+        const auto byte = input_[position];
+        if (byte < 0x40U || byte > 0x7EU) {
+            continue;
+        }
+        input_begin_ = position + 1U;
+        switch (byte) {
+            case 'A': key = {KeyType::ArrowUp}; break;
+            case 'B': key = {KeyType::ArrowDown}; break;
+            case 'C': key = {KeyType::ArrowRight}; break;
+            case 'D': key = {KeyType::ArrowLeft}; break;
+            default: key = {KeyType::Unknown}; break;
+        }
+        return true;
+    }
+    if (more_may_follow && input_end_ < input_.size()) {
+        return false;
+    }
+    // Truncated sequence, drop it
+    input_begin_ = input_end_;
+    key = {KeyType::Unknown};
+    return true;
+}
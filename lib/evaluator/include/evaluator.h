@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+namespace Eval {
+
+constexpr size_t pow3(size_t exponent) {
+    return exponent == 0U ? 1U : 3U * pow3(exponent - 1U);
+}
+
+// Features are the contents of every row, column and both diagonals: one feature per line
+// and line state, the state being the line's cells in base 3 (Board::BoardField values)
+constexpr size_t kLineCount = 2U * Board::kBoardSize + 2U;
+constexpr size_t kLineStates = pow3(Board::kBoardSize);
+constexpr size_t kFeatureCount = kLineCount * kLineStates;
+constexpr size_t kHiddenSize = 32U;         // two AVX2 registers of int16
+constexpr int16_t kActivationMax = 127;     // clipped ReLU of the hidden layer
+
+// Weights file layout (little endian), the arrays start 32 byte aligned:
+//   header:  "TTTW" magic, u8 version, u8 board size, u16 hidden size, u32 feature count, 20 reserved bytes
+//   int16    hidden_weights[feature count][hidden size]
+//   int16    hidden_bias[hidden size]
+//   int16    output_weights[hidden size]
+//   int32    output_bias
+constexpr char kWeightsMagic[4] = {'T', 'T', 'T', 'W'};
+constexpr uint8_t kWeightsVersion = 1U;
+constexpr size_t kWeightsHeaderSize = 32U;
+
+// Read-only weights of the two layer network, shared by all evaluators and threads
+class Network {
+public:
+    // Maps the weights file, throws std::runtime_error when it is missing or does not match the build
+    static std::shared_ptr<const Network> load(const std::string &path);
+    // Hand written weights scoring open lines, used without a weights file
+    static std::shared_ptr<const Network> builtIn();
+
+    ~Network();
+    Network(const Network &) = delete;
+    Network &operator=(const Network &) = delete;
+
+    // Writes the weights in the file layout above
+    bool save(const std::string &path) const;
+
+    const int16_t *hiddenWeights(size_t feature) const {
+        return hidden_weights_ + feature * kHiddenSize;
+    }
+
+    const int16_t *hiddenBias() const {
+        return hidden_bias_;
+    }
+
+    const int16_t *outputWeights() const {
+        return output_weights_;
+    }
+
+    int32_t outputBias() const {
+        return output_bias_;
+    }
+
+private:
+    Network() = default;
+
+    const int16_t *hidden_weights_ = nullptr;
+    const int16_t *hidden_bias_ = nullptr;
+    const int16_t *output_weights_ = nullptr;
+    int32_t output_bias_ = 0;
+
+    // Either a file mapping or owned storage
+    const void *mapping_ = nullptr;
+    size_t mapping_size_ = 0U;
+    std::vector<int16_t> storage_;
+};
+
+// Name of the kernels chosen for this CPU, "avx2" or "portable"
+const char *kernelName();
+
+class IEvaluator {
+public:
+    virtual ~IEvaluator() = default;
+    virtual void reset(const Board::BoardType &board) = 0;
+    // Incremental updates, unmake() must undo the last make() of the same cell
+    virtual void make(int row, int col, Board::BoardField field) = 0;
+    virtual void unmake(int row, int col, Board::BoardField field) = 0;
+    // Score of the current position for X, positive is good for X
+    virtual int32_t evaluate() const = 0;
+};
+
+// Keeps the hidden layer of the current position as an accumulator. A move changes the state of
+// at most four lines, so make() and unmake() only subtract and add those weight rows instead of
+// recomputing the layer.
+class NetworkEvaluator final : public IEvaluator {
+public:
+    explicit NetworkEvaluator(std::shared_ptr<const Network> network);
+
+    void reset(const Board::BoardType &board) override;
+    void make(int row, int col, Board::BoardField field) override;
+    void unmake(int row, int col, Board::BoardField field) override;
+    int32_t evaluate() const override;
+
+private:
+    std::shared_ptr<const Network> network_;
+    alignas(32) std::array<int16_t, kHiddenSize> accumulator_ {};
+    std::array<uint16_t, kLineCount> line_states_ {};
+
+    void update(int row, int col, int delta);
+};
+
+} // namespace Eval
@@ -0,0 +1,326 @@
+#include "evaluator.h"
+
+#include "log.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define EVAL_HAS_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Eval {
+
+namespace {
+
+constexpr size_t kHiddenWeightCount = kFeatureCount * kHiddenSize;
+constexpr size_t kWeightsFileSize = kWeightsHeaderSize + (kHiddenWeightCount + 2U * kHiddenSize) * sizeof(int16_t) +
+                                    sizeof(int32_t);
+
+// Lines through a cell and the base 3 digit the cell has in each of them
+struct CellLines {
+    std::array<uint8_t, 4> lines {};
+    std::array<uint16_t, 4> powers {};
+    size_t count = 0;
+};
+
+using CellTable = std::array<std::array<CellLines, Board::kBoardSize>, Board::kBoardSize>;
+
+constexpr CellTable buildCellTable() {
+    CellTable table {};
+    auto add = [&](size_t row, size_t col, size_t line, size_t position) {
+        auto &cell = table[row][col];
+        cell.lines[cell.count] = static_cast<uint8_t>(line);
+        cell.powers[cell.count] = static_cast<uint16_t>(pow3(position));
+        ++cell.count;
+    };
+    constexpr size_t kSize = Board::kBoardSize;
+    for (size_t row = 0; row < kSize; ++row) {
+        for (size_t col = 0; col < kSize; ++col) {
+            add(row, col, row, col);                // rows
+            add(row, col, kSize + col, row);        // columns
+            if (row == col) {
+                add(row, col, 2U * kSize, row);     // main diagonal
+            }
+            if (row + col == kSize - 1U) {
+                add(row, col, 2U * kSize + 1U, row);    // anti diagonal
+            }
+        }
+    }
+    return table;
+}
+
+constexpr CellTable kCellTable = buildCellTable();
+
+// Kernels over the kHiddenSize accumulator
+struct Kernels {
+    const char *name;
+    void (*replace)(int16_t *accumulator, const int16_t *removed, const int16_t *added);
+    int32_t (*output)(const int16_t *accumulator, const int16_t *weights);
+};
+
+void replacePortable(int16_t *accumulator, const int16_t *removed, const int16_t *added) {
+    for (size_t i = 0; i < kHiddenSize; ++i) {
+        accumulator[i] = static_cast<int16_t>(accumulator[i] - removed[i] + added[i]);
+    }
+}
+
+int32_t outputPortable(const int16_t *accumulator, const int16_t *weights) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < kHiddenSize; ++i) {
+        const auto activation = std::clamp<int16_t>(accumulator[i], 0, kActivationMax);
+        sum += static_cast<int32_t>(activation) * weights[i];
+    }
+    return sum;
+}
+
+#ifdef EVAL_HAS_AVX2_KERNELS
+static_assert(kHiddenSize % 16U == 0U, "AVX2 kernels process 16 hidden units per register");
+
+__attribute__((target("avx2")))
+void replaceAvx2(int16_t *accumulator, const int16_t *removed, const int16_t *added) {
+    for (size_t i = 0; i < kHiddenSize; i += 16U) {
+        auto *slot = reinterpret_cast<__m256i *>(accumulator + i);
+        auto value = _mm256_loadu_si256(slot);
+        value = _mm256_sub_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(removed + i)));
+        value = _mm256_add_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(added + i)));
+        _mm256_storeu_si256(slot, value);
+    }
+}
+
+__attribute__((target("avx2")))
+int32_t outputAvx2(const int16_t *accumulator, const int16_t *weights) {
+    const auto zero = _mm256_setzero_si256();
+    const auto max = _mm256_set1_epi16(kActivationMax);
+    auto sum = _mm256_setzero_si256();
+    for (size_t i = 0; i < kHiddenSize; i += 16U) {
+        auto activation = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(accumulator + i));
+        activation = _mm256_min_epi16(_mm256_max_epi16(activation, zero), max);
+        const auto weight = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+        // Pairwise products summed into eight int32 lanes
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(activation, weight));
+    }
+    auto half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+#endif
+
+Kernels selectKernels() {
+#ifdef EVAL_HAS_AVX2_KERNELS
+    if (__builtin_cpu_supports("avx2")) {
+        return {"avx2", replaceAvx2, outputAvx2};
+    }
+#endif
+    return {"portable", replacePortable, outputPortable};
+}
+
+const Kernels &kernels() {
+    static const Kernels selected = [] {
+        const auto chosen = selectKernels();
+        LOG_I("Evaluator kernels: {}", chosen.name);
+        return chosen;
+    }();
+    return selected;
+}
+
+// Built-in weights: lines held by one side only score 1, 4, 16 for 1, 2, 3 pieces
+int16_t lineScore(size_t state) {
+    size_t x_count = 0;
+    size_t o_count = 0;
+    for (size_t i = 0; i < Board::kBoardSize; ++i, state /= 3U) {
+        switch (static_cast<Board::BoardField>(state % 3U)) {
+            case Board::BoardField::X:
+                ++x_count;
+                break;
+            case Board::BoardField::O:
+                ++o_count;
+                break;
+            default:
+                break;
+        }
+    }
+    if (x_count != 0U && o_count != 0U) {
+        return 0;
+    }
+    const auto count = x_count + o_count;
+    const auto score = count == 0U ? 0 : 1 << (2U * (count - 1U));
+    return static_cast<int16_t>(x_count != 0U ? score : -score);
+}
+
+} // namespace
+
+std::shared_ptr<const Network> Network::load(const std::string &path) {
+    if constexpr (std::endian::native != std::endian::little) {
+        throw std::runtime_error("Weights files are only supported on little endian hosts");
+    }
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open weights file " + path + ": " + std::strerror(errno));
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) != kWeightsFileSize) {
+        ::close(fd);
+        throw std::runtime_error("Weights file " + path + " has wrong size, expected " +
+                                 std::to_string(kWeightsFileSize) + " bytes");
+    }
+    void *mapping = ::mmap(nullptr, kWeightsFileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map weights file " + path + ": " + std::strerror(errno));
+    }
+
+    std::shared_ptr<Network> network(new Network());
+    network->mapping_ = mapping;
+    network->mapping_size_ = kWeightsFileSize;
+
+    const auto *bytes = static_cast<const uint8_t *>(mapping);
+    uint16_t hidden_size = 0;
+    uint32_t feature_count = 0;
+    std::memcpy(&hidden_size, bytes + 6, sizeof(hidden_size));
+    std::memcpy(&feature_count, bytes + 8, sizeof(feature_count));
+    if (std::memcmp(bytes, kWeightsMagic, sizeof(kWeightsMagic)) != 0 || bytes[4] != kWeightsVersion ||
+        bytes[5] != Board::kBoardSize || hidden_size != kHiddenSize || feature_count != kFeatureCount) {
+        throw std::runtime_error("Weights file " + path + " does not match this build");
+    }
+
+    // Page aligned mapping, every array starts at a multiple of 32 bytes
+    const auto *weights = reinterpret_cast<const int16_t *>(bytes + kWeightsHeaderSize);
+    network->hidden_weights_ = weights;
+    network->hidden_bias_ = weights + kHiddenWeightCount;
+    network->output_weights_ = network->hidden_bias_ + kHiddenSize;
+    std::memcpy(&network->output_bias_, network->output_weights_ + kHiddenSize, sizeof(network->output_bias_));
+    LOG_I("Weights loaded from {}", path);
+    return network;
+}
+
+std::shared_ptr<const Network> Network::builtIn() {
+    std::shared_ptr<Network> network(new Network());
+    auto &storage = network->storage_;
+    storage.assign(kHiddenWeightCount + 2U * kHiddenSize, 0);
+
+    // Unit 0 sums the line scores, unit 1 their negation, both biased to the middle of the
+    // clipped range so the output is twice the score while it stays within it
+    constexpr int16_t kBias = kActivationMax / 2;
+    for (size_t line = 0; line < kLineCount; ++line) {
+        for (size_t state = 0; state < kLineStates; ++state) {
+            const auto score = lineScore(state);
+            auto *row = storage.data() + (line * kLineStates + state) * kHiddenSize;
+            row[0] = score;
+            row[1] = static_cast<int16_t>(-score);
+        }
+    }
+    auto *bias = storage.data() + kHiddenWeightCount;
+    bias[0] = kBias;
+    bias[1] = kBias;
+    auto *output = bias + kHiddenSize;
+    output[0] = 1;
+    output[1] = -1;
+
+    network->hidden_weights_ = storage.data();
+    network->hidden_bias_ = bias;
+    network->output_weights_ = output;
+    network->output_bias_ = 0;
+    return network;
+}
+
+Network::~Network() {
+    if (mapping_ != nullptr) {
+        ::munmap(const_cast<void *>(mapping_), mapping_size_);
+    }
+}
+
+bool Network::save(const std::string &path) const {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        LOG_E("Cannot create weights file {}", path);
+        return false;
+    }
+    std::array<uint8_t, kWeightsHeaderSize> header {};
+    const uint16_t hidden_size = kHiddenSize;
+    const uint32_t feature_count = kFeatureCount;
+    std::memcpy(header.data(), kWeightsMagic, sizeof(kWeightsMagic));
+    header[4] = kWeightsVersion;
+    header[5] = Board::kBoardSize;
+    std::memcpy(header.data() + 6, &hidden_size, sizeof(hidden_size));
+    std::memcpy(header.data() + 8, &feature_count, sizeof(feature_count));
+
+    bool written = std::fwrite(header.data(), header.size(), 1U, file) == 1U &&
+                   std::fwrite(hidden_weights_, sizeof(int16_t), kHiddenWeightCount, file) == kHiddenWeightCount &&
+                   std::fwrite(hidden_bias_, sizeof(int16_t), kHiddenSize, file) == kHiddenSize &&
+                   std::fwrite(output_weights_, sizeof(int16_t), kHiddenSize, file) == kHiddenSize &&
+                   std::fwrite(&output_bias_, sizeof(output_bias_), 1U, file) == 1U;
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        LOG_E("Cannot write weights file {}", path);
+    }
+    return written;
+}
+
+const char *kernelName() {
+    return kernels().name;
+}
+
+NetworkEvaluator::NetworkEvaluator(std::shared_ptr<const Network> network) :
+    network_(std::move(network)) {
+    if (!network_) {
+        throw std::runtime_error("Evaluator needs a network");
+    }
+    reset(Board::BoardType {});
+}
+
+void NetworkEvaluator::reset(const Board::BoardType &board) {
+    std::copy_n(network_->hiddenBias(), kHiddenSize, accumulator_.begin());
+    line_states_.fill(0U);
+    // Empty lines are active features as well
+    for (size_t line = 0; line < kLineCount; ++line) {
+        const auto *weights = network_->hiddenWeights(line * kLineStates);
+        for (size_t i = 0; i < kHiddenSize; ++i) {
+            accumulator_[i] = static_cast<int16_t>(accumulator_[i] + weights[i]);
+        }
+    }
+    for (size_t row = 0; row < Board::kBoardSize; ++row) {
+        for (size_t col = 0; col < Board::kBoardSize; ++col) {
+            if (board[row][col] != Board::BoardField::EMPTY) {
+                make(static_cast<int>(row), static_cast<int>(col), board[row][col]);
+            }
+        }
+    }
+}
+
+void NetworkEvaluator::make(int row, int col, Board::BoardField field) {
+    update(row, col, static_cast<int>(field));
+}
+
+void NetworkEvaluator::unmake(int row, int col, Board::BoardField field) {
+    update(row, col, -static_cast<int>(field));
+}
+
+int32_t NetworkEvaluator::evaluate() const {
+    return kernels().output(accumulator_.data(), network_->outputWeights()) + network_->outputBias();
+}
+
+void NetworkEvaluator::update(int row, int col, int delta) {
+    const auto &cell = kCellTable[row][col];
+    const auto &selected = kernels();
+    for (size_t i = 0; i < cell.count; ++i) {
+        const auto line = cell.lines[i];
+        const auto old_state = line_states_[line];
+        const auto new_state = static_cast<uint16_t>(old_state + delta * cell.powers[i]);
+        selected.replace(accumulator_.data(), network_->hiddenWeights(line * kLineStates + old_state),
+                         network_->hiddenWeights(line * kLineStates + new_state));
+        line_states_[line] = new_state;
+    }
+}
+
+} // namespace Eval
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <stop_token>
 #include <utility>
 #include "player_manager.h"
 #include "board.h"
+#include "game_result_type.h"
+#include "game_record.h"
+#include "task.h"
 
 namespace GameEngine {
 
@@ -12,19 +19,69 @@ enum class GameEngineError {
     kInvalidMove,
     kInvalidPlayer,
     kGameFinished,
-    KBoardNotClear
+    KBoardNotClear,
+    kInvalidSnapshot,
+    kCancelled          // stop was requested while the player was moving, the board is unchanged
+};
+
+// Binary image of the whole engine state (little endian):
+//   "TTTE" magic, version, flags (host turn, host started round, game finished), board size,
+//   number of moves in the current round, u32 host score, u32 guest score, u32 rounds played,
+//   board fields packed 2 bits each, current round moves as cell indices
+constexpr size_t kSnapshotBoardBytes = (Board::kBoardSize * Board::kBoardSize * 2U + 7U) / 8U;
+constexpr size_t kSnapshotSize = 8U + 3U * sizeof(uint32_t) + kSnapshotBoardBytes + Board::kBoardSize * Board::kBoardSize;
+using Snapshot = std::array<uint8_t, kSnapshotSize>;
+
+// Decoded snapshot, lets state rebuilt outside an engine (e.g. by journal replay) be restored
+struct EngineState {
+    Board::BoardType board {};
+    std::array<uint16_t, Board::kBoardSize * Board::kBoardSize> round_moves {};   // cell indices
+    size_t round_move_count = 0;
+    size_t host_score = 0;
+    size_t guest_score = 0;
+    size_t rounds_played = 0;
+    bool host_turn = true;
+    bool host_started_round = true;
+    bool game_finished = false;
+};
+
+Snapshot encodeSnapshot(const EngineState &state);
+// Empty for a snapshot with a wrong header or a state no game reaches, e.g. a move count
+// not matching the pieces on the board
+std::optional<EngineState> decodeSnapshot(const Snapshot &snapshot);
+
+// Observer of engine state changes, called synchronously on the thread driving the engine
+class IGameEventListener {
+public:
+    virtual ~IGameEventListener() = default;
+    // move_number counts the moves of the current round starting at 1
+    virtual void onMove(std::pair<int, int> move, BoardPlayerType player_type, size_t move_number) = 0;
+    virtual void onRoundEnd(RoundResult result, std::pair<int, int> score, size_t round) = 0;
+    // The board was cleared, host_turn tells who moves first
+    virtual void onReset(bool host_turn, bool host_started_round) = 0;
 };
 
 class IGameEngine {
 public:
     virtual ~IGameEngine() = default;
 
-    virtual GameEngineError processGame() = 0;
+    // The stop token is handed to the moving player, a requested stop ends the move with kCancelled
+    virtual GameEngineError processGame(const std::stop_token &stop) = 0;
+    // Coroutine version of processGame(), suspends while the current player has no move ready.
+    // The token is taken by value, a suspended coroutine must not refer to the caller's copy.
+    virtual Coro::Task<GameEngineError> processGameAsync(std::stop_token stop) = 0;
     virtual void resetGame() = 0;
     virtual void resetBoard() = 0;
 
     virtual Board::BoardType getBoard() const = 0;
     virtual std::pair<int, int> getScore() const  = 0;
+    virtual size_t getRoundsPlayed() const = 0;
+
+    // Save and load the complete state, a restored engine continues the game where it stopped
+    virtual Snapshot snapshot() const = 0;
+    virtual GameEngineError restore(const Snapshot &snapshot) = 0;
+
+    virtual void addEventListener(std::shared_ptr<IGameEventListener> listener) = 0;
 };
 
 class GameEngineImpl;
@@ -32,11 +89,17 @@ class GameEngineImpl;
 class GameEngine : public IGameEngine {
 
 public:
-    explicit GameEngine(std::shared_ptr<PlayerManager::PlayerManager> playerManagerPtr, size_t board_size);
+    // When record_writer is set every finished round is appended to it as a game record
+    explicit GameEngine(std::shared_ptr<PlayerManager::PlayerManager> playerManagerPtr, size_t board_size,
+                        std::shared_ptr<GameRecord::IGameRecordWriter> record_writer = nullptr);
     ~GameEngine() = default;
 
-    GameEngineError processGame() override {
-        return impl_->processGame();
+    GameEngineError processGame(const std::stop_token &stop) override {
+        return impl_->processGame(stop);
+    }
+
+    Coro::Task<GameEngineError> processGameAsync(std::stop_token stop) override {
+        return impl_->processGameAsync(std::move(stop));
     }
 
     Board::BoardType getBoard() const override {
@@ -47,6 +110,18 @@ public:
         return impl_->getScore();
     }
 
+    size_t getRoundsPlayed() const override {
+        return impl_->getRoundsPlayed();
+    }
+
+    Snapshot snapshot() const override {
+        return impl_->snapshot();
+    }
+
+    GameEngineError restore(const Snapshot &snapshot) override {
+        return impl_->restore(snapshot);
+    }
+
     void resetGame() override {
         impl_->resetGame();
     }
@@ -55,6 +130,10 @@ public:
         impl_->resetBoard();
     }
 
+    void addEventListener(std::shared_ptr<IGameEventListener> listener) override {
+        impl_->addEventListener(std::move(listener));
+    }
+
 private:
     std::unique_ptr<IGameEngine> impl_;
 };
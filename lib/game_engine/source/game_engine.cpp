@@ -1,20 +1,158 @@
 #include "game_engine.h"
 #include "log.h"
+#include "metrics.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
 
 
 namespace GameEngine {
 
+constexpr std::array<uint8_t, 4> kSnapshotMagic = {'T', 'T', 'T', 'E'};
+constexpr uint8_t kSnapshotVersion = 1U;
+constexpr uint8_t kSnapshotHostTurn = 0x01U;
+constexpr uint8_t kSnapshotHostStartRound = 0x02U;
+constexpr uint8_t kSnapshotGameFinished = 0x04U;
+constexpr size_t kSnapshotScoresOffset = 8U;
+constexpr size_t kSnapshotBoardOffset = kSnapshotScoresOffset + 3U * sizeof(uint32_t);
+constexpr size_t kSnapshotMovesOffset = kSnapshotBoardOffset + kSnapshotBoardBytes;
+
+namespace {
+
+void storeU32(uint8_t *out, uint32_t value) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8U * i));
+    }
+}
+
+uint32_t loadU32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<uint32_t>(in[i]) << (8U * i);
+    }
+    return value;
+}
+
+Board::BoardField fieldAt(const Board::BoardType &board, size_t cell) {
+    return board[cell / Board::kBoardSize][cell % Board::kBoardSize];
+}
+
+// Snapshots come from another process, reject every state the engine itself never reaches
+bool isReachable(const EngineState &state) {
+    constexpr size_t kCells = Board::kBoardSize * Board::kBoardSize;
+    size_t occupied = 0;
+    for (size_t cell = 0; cell < kCells; ++cell) {
+        occupied += fieldAt(state.board, cell) != Board::BoardField::EMPTY ? 1U : 0U;
+    }
+    if (state.round_move_count != occupied) {
+        return false;
+    }
+    // Every piece is one move of the round, the players alternate
+    std::array<bool, kCells> played {};
+    for (size_t move = 0; move < state.round_move_count; ++move) {
+        const auto cell = state.round_moves[move];
+        if (cell >= kCells || played[cell] || fieldAt(state.board, cell) == Board::BoardField::EMPTY ||
+            (move > 0U && fieldAt(state.board, cell) == fieldAt(state.board, state.round_moves[move - 1U]))) {
+            return false;
+        }
+        played[cell] = true;
+    }
+    // A round ends with its winning or last move
+    const bool x_won = Board::isPlayerWinner(state.board, BoardPlayerType::X);
+    const bool o_won = Board::isPlayerWinner(state.board, BoardPlayerType::O);
+    if (x_won || o_won) {
+        const auto last = fieldAt(state.board, state.round_moves[state.round_move_count - 1U]);
+        if (x_won == o_won || last != (x_won ? Board::BoardField::X : Board::BoardField::O)) {
+            return false;
+        }
+    }
+    return state.game_finished == (x_won || o_won || occupied == kCells);
+}
+
+} // namespace
+
+Snapshot encodeSnapshot(const EngineState &state) {
+    Snapshot snapshot {};
+    std::ranges::copy(kSnapshotMagic, snapshot.begin());
+    snapshot[4] = kSnapshotVersion;
+    snapshot[5] = (state.host_turn ? kSnapshotHostTurn : 0U) |
+                  (state.host_started_round ? kSnapshotHostStartRound : 0U) |
+                  (state.game_finished ? kSnapshotGameFinished : 0U);
+    snapshot[6] = static_cast<uint8_t>(Board::kBoardSize);
+    snapshot[7] = static_cast<uint8_t>(state.round_move_count);
+    storeU32(&snapshot[kSnapshotScoresOffset], static_cast<uint32_t>(state.host_score));
+    storeU32(&snapshot[kSnapshotScoresOffset + 4U], static_cast<uint32_t>(state.guest_score));
+    storeU32(&snapshot[kSnapshotScoresOffset + 8U], static_cast<uint32_t>(state.rounds_played));
+
+    for (size_t cell = 0; cell < Board::kBoardSize * Board::kBoardSize; ++cell) {
+        const auto field = static_cast<uint8_t>(state.board[cell / Board::kBoardSize][cell % Board::kBoardSize]);
+        snapshot[kSnapshotBoardOffset + cell / 4U] |= static_cast<uint8_t>(field << (2U * (cell % 4U)));
+    }
+    for (size_t move = 0; move < state.round_move_count; ++move) {
+        snapshot[kSnapshotMovesOffset + move] = static_cast<uint8_t>(state.round_moves[move]);
+    }
+    return snapshot;
+}
+
+std::optional<EngineState> decodeSnapshot(const Snapshot &snapshot) {
+    if (!std::equal(kSnapshotMagic.begin(), kSnapshotMagic.end(), snapshot.begin()) ||
+        snapshot[4] != kSnapshotVersion ||
+        snapshot[6] != Board::kBoardSize ||
+        snapshot[7] > Board::kBoardSize * Board::kBoardSize) {
+        LOG_W("Invalid game engine snapshot");
+        return std::nullopt;
+    }
+
+    EngineState state;
+    for (size_t cell = 0; cell < Board::kBoardSize * Board::kBoardSize; ++cell) {
+        const auto field = (snapshot[kSnapshotBoardOffset + cell / 4U] >> (2U * (cell % 4U))) & 0x03U;
+        if (field > static_cast<uint8_t>(Board::BoardField::O)) {
+            LOG_W("Invalid board field in game engine snapshot");
+            return std::nullopt;
+        }
+        state.board[cell / Board::kBoardSize][cell % Board::kBoardSize] = static_cast<Board::BoardField>(field);
+    }
+    state.host_turn = (snapshot[5] & kSnapshotHostTurn) != 0U;
+    state.host_started_round = (snapshot[5] & kSnapshotHostStartRound) != 0U;
+    state.game_finished = (snapshot[5] & kSnapshotGameFinished) != 0U;
+    state.host_score = loadU32(&snapshot[kSnapshotScoresOffset]);
+    state.guest_score = loadU32(&snapshot[kSnapshotScoresOffset + 4U]);
+    state.rounds_played = loadU32(&snapshot[kSnapshotScoresOffset + 8U]);
+    state.round_move_count = snapshot[7];
+    for (size_t move = 0; move < state.round_move_count; ++move) {
+        state.round_moves[move] = snapshot[kSnapshotMovesOffset + move];
+    }
+    if (!isReachable(state)) {
+        LOG_W("Inconsistent game engine snapshot");
+        return std::nullopt;
+    }
+    return state;
+}
+
 class GameEngineImpl : public IGameEngine {
 public:
-    explicit GameEngineImpl(std::shared_ptr<PlayerManager::PlayerManager> playerManagerPtr, size_t board_size):
+    explicit GameEngineImpl(std::shared_ptr<PlayerManager::PlayerManager> playerManagerPtr, size_t board_size,
+                            std::shared_ptr<GameRecord::IGameRecordWriter> record_writer):
             playerManagerPtr_(playerManagerPtr),
-            board_size_(board_size) {
+            board_size_(board_size),
+            record_writer_(std::move(record_writer)) {
         LOG_I("Creating game engine with board size: {}", board_size);
+        // Players are owned by the player manager which outlives the engine, keep raw pointers
+        // so the move dispatch path does not touch the shared_ptr reference counts
+        host_player_ = playerManagerPtr_->getHostClient().get();
+        guest_player_ = playerManagerPtr_->getGuestClient().get();
+        host_player_type_ = host_player_->get_player_type();
+        guest_player_type_ = guest_player_->get_player_type();
+        host_player_kind_ = host_player_->get_player_kind();
+        guest_player_kind_ = guest_player_->get_player_kind();
 
     }
 
-    GameEngineError processGame() override {
-        auto return_code = GameEngineError::kOK;
+    GameEngineError processGame(const std::stop_token &stop) override {
+        TRACE_SPAN("engine", "process_game");
         if (is_game_finished_) {
             LOG_W("Game is finished. Please reset the game.");
             return GameEngineError::KBoardNotClear;
@@ -22,42 +160,48 @@ public:
 
         LOG_V("Next game loop");
         auto [current_player, player_type] = this->getCurrentPlayer();
-        const auto [host_player, host_player_type] = getHostPlayer();
+        const auto player_kind = getCurrentPlayerKind();
 
-        auto board = Board::Board(board_.get_board());
-        const auto [row, col] = current_player->get_move(std::move(board));
+        const auto think_start = std::chrono::steady_clock::now();
+        std::pair<int, int> move;
+        {
+            TRACE_SPAN("engine", "get_move");
+            move = current_player->get_move(board_.view(), stop);
+        }
+        Metrics::recordTime(Metrics::Timer::MoveThink, player_kind, std::chrono::steady_clock::now() - think_start);
+        if (stop.stop_requested()) {
+            LOG_D("Move cancelled");
+            return GameEngineError::kCancelled;
+        }
 
-        if (!board_.is_valid_move(row, col)) {
-            LOG_W("Invalid move");
-            return GameEngineError::kInvalidMove;
+        TRACE_SPAN("engine", "apply_move");
+        Metrics::ScopedTimer update_timer(Metrics::Timer::MoveUpdate, player_kind);
+        return applyMove(move, player_type);
+    }
+
+    Coro::Task<GameEngineError> processGameAsync(std::stop_token stop) override {
+        if (is_game_finished_) {
+            LOG_W("Game is finished. Please reset the game.");
+            co_return GameEngineError::KBoardNotClear;
         }
 
-        auto move_result = board_.make_move(row, col, player_type);
-        if (move_result.has_value()) {
-            if (board_.is_winner(player_type)) {
-                LOG_I("Player {} won", static_cast<int>(player_type));
-                if (player_type == host_player_type) {
-                    host_player_score_++;
-                } else {
-                    guest_player_score_++;
-                }
-                is_game_finished_ = true;
-                return_code = GameEngineError::kGameFinished;
-            } else if (board_.is_full()) {
-                LOG_I("Board is full, game finished without winner");
-                is_game_finished_ = true;
-                return_code = GameEngineError::kGameFinished;
-            } else {
-                LOG_V("Game continues");
-            }
-        } else {
-            LOG_W("Invalid move, error: {}", static_cast<int>(move_result.error()));
-            return GameEngineError::kInvalidMove;
+        LOG_V("Next game loop (async)");
+        auto [current_player, player_type] = this->getCurrentPlayer();
+        const auto player_kind = getCurrentPlayerKind();
+
+        // The board is not modified while the coroutine is suspended, so the view stays valid
+        const auto think_start = std::chrono::steady_clock::now();
+        const auto move = co_await current_player->next_move(board_.view(), stop);
+        Metrics::recordTime(Metrics::Timer::MoveThink, player_kind, std::chrono::steady_clock::now() - think_start);
+        if (stop.stop_requested()) {
+            LOG_D("Move cancelled");
+            co_return GameEngineError::kCancelled;
         }
 
-        // if move is valid, change turn
-        is_host_turn_ = !is_host_turn_;
-        return return_code;
+        // Spans must not cross the co_await above, the coroutine may resume on another thread
+        TRACE_SPAN("engine", "apply_move");
+        Metrics::ScopedTimer update_timer(Metrics::Timer::MoveUpdate, player_kind);
+        co_return applyMove(move, player_type);
     }
 
     Board::BoardType getBoard() const override {
@@ -68,17 +212,68 @@ public:
         return {host_player_score_, guest_player_score_};
     }
 
+    size_t getRoundsPlayed() const override {
+        return rounds_played_;
+    }
+
+    Snapshot snapshot() const override {
+        return encodeSnapshot(EngineState{
+            .board = board_.get_board(),
+            .round_moves = round_moves_,
+            .round_move_count = round_move_count_,
+            .host_score = host_player_score_,
+            .guest_score = guest_player_score_,
+            .rounds_played = rounds_played_,
+            .host_turn = is_host_turn_,
+            .host_started_round = is_host_start_round_,
+            .game_finished = is_game_finished_
+        });
+    }
+
+    GameEngineError restore(const Snapshot &snapshot) override {
+        const auto state = decodeSnapshot(snapshot);
+        if (!state.has_value()) {
+            return GameEngineError::kInvalidSnapshot;
+        }
+        // The player to move cannot be the one who made the last move
+        const auto next_player_type = state->host_turn ? host_player_type_ : guest_player_type_;
+        if (state->round_move_count > 0U &&
+            fieldAt(state->board, state->round_moves[state->round_move_count - 1U]) ==
+                Board::convertPlayerTypeToBoardField(next_player_type)) {
+            LOG_W("Game engine snapshot turn does not match the board");
+            return GameEngineError::kInvalidSnapshot;
+        }
+        board_.set_board(state->board);
+        is_host_turn_ = state->host_turn;
+        is_host_start_round_ = state->host_started_round;
+        is_game_finished_ = state->game_finished;
+        host_player_score_ = state->host_score;
+        guest_player_score_ = state->guest_score;
+        rounds_played_ = state->rounds_played;
+        round_move_count_ = state->round_move_count;
+        round_moves_ = state->round_moves;
+        LOG_I("Game engine restored, score {}:{}, rounds {}", host_player_score_, guest_player_score_, rounds_played_);
+        return GameEngineError::kOK;
+    }
+
     void resetGame() override {
         LOG_I("Resetting game engine");
-        resetBoard();
+        clearBoard();
         is_host_start_round_ = !is_host_start_round_;
         is_host_turn_ = is_host_start_round_;
+        notifyReset();
     }
 
     void resetBoard() override {
         LOG_I("Resetting board");
-        board_.reset();
-        is_game_finished_ = false;
+        clearBoard();
+        notifyReset();
+    }
+
+    void addEventListener(std::shared_ptr<IGameEventListener> listener) override {
+        if (listener != nullptr) {
+            listeners_.push_back(std::move(listener));
+        }
     }
 
 private:
@@ -87,33 +282,122 @@ private:
     Board::Board board_;
     size_t host_player_score_{0};
     size_t guest_player_score_{0};
+    size_t rounds_played_{0};
     bool is_host_turn_{true};
     bool is_game_finished_{false};
     bool is_host_start_round_{true};
 
-    std::pair<std::shared_ptr<Player::IPlayer>, BoardPlayerType> getHostPlayer() {
-        return {playerManagerPtr_->getHostClient(),
-                playerManagerPtr_->getHostClient()->get_player_type()};
+    // Moves of the current round as cell indices, kept for the game record
+    std::shared_ptr<GameRecord::IGameRecordWriter> record_writer_;
+    std::array<uint16_t, Board::kBoardSize * Board::kBoardSize> round_moves_{};
+    size_t round_move_count_{0};
+
+    Player::IPlayer *host_player_{nullptr};
+    Player::IPlayer *guest_player_{nullptr};
+    BoardPlayerType host_player_type_{BoardPlayerType::X};
+    BoardPlayerType guest_player_type_{BoardPlayerType::O};
+    PlayerKind host_player_kind_{PlayerKind::Human};
+    PlayerKind guest_player_kind_{PlayerKind::Bot};
+
+    std::vector<std::shared_ptr<IGameEventListener>> listeners_;
+
+    void clearBoard() {
+        board_.reset();
+        round_move_count_ = 0;
+        is_game_finished_ = false;
+    }
+
+    void notifyReset() {
+        for (const auto &listener : listeners_) {
+            listener->onReset(is_host_turn_, is_host_start_round_);
+        }
+    }
+
+    GameEngineError applyMove(std::pair<int, int> move, BoardPlayerType player_type) {
+        auto return_code = GameEngineError::kOK;
+        const auto [row, col] = move;
+
+        if (!board_.is_valid_move(row, col)) {
+            LOG_W("Invalid move");
+            Metrics::increment(Metrics::Counter::InvalidMoves);
+            return GameEngineError::kInvalidMove;
+        }
+
+        auto move_result = board_.make_move(row, col, player_type);
+        if (move_result.has_value()) {
+            round_moves_[round_move_count_++] = static_cast<uint16_t>(row * Board::kBoardSize + col);
+            Metrics::increment(Metrics::Counter::Moves);
+            for (const auto &listener : listeners_) {
+                listener->onMove(move, player_type, round_move_count_);
+            }
+            if (board_.is_winner(player_type)) {
+                LOG_I("Player {} won", static_cast<int>(player_type));
+                auto round_result = RoundResult::GuestWin;
+                if (player_type == host_player_type_) {
+                    host_player_score_++;
+                    round_result = RoundResult::HostWin;
+                } else {
+                    guest_player_score_++;
+                }
+                is_game_finished_ = true;
+                ++rounds_played_;
+                recordRound(round_result);
+                return_code = GameEngineError::kGameFinished;
+            } else if (board_.is_full()) {
+                LOG_I("Board is full, game finished without winner");
+                is_game_finished_ = true;
+                ++rounds_played_;
+                recordRound(RoundResult::Draw);
+                return_code = GameEngineError::kGameFinished;
+            } else {
+                LOG_V("Game continues");
+            }
+        } else {
+            LOG_W("Invalid move, error: {}", static_cast<int>(move_result.error()));
+            Metrics::increment(Metrics::Counter::InvalidMoves);
+            return GameEngineError::kInvalidMove;
+        }
+
+        // if move is valid, change turn
+        is_host_turn_ = !is_host_turn_;
+        return return_code;
+    }
+
+    void recordRound(RoundResult result) {
+        Metrics::increment(Metrics::Counter::Rounds);
+        for (const auto &listener : listeners_) {
+            listener->onRoundEnd(result, getScore(), rounds_played_);
+        }
+        if (record_writer_ == nullptr) {
+            return;
+        }
+        record_writer_->append(GameRecord::GameRecordData{
+            .board_size = static_cast<uint8_t>(Board::kBoardSize),
+            .result = result,
+            .host_started = is_host_start_round_,
+            .host_player_type = host_player_type_,
+            .moves = std::span<const uint16_t>(round_moves_.data(), round_move_count_)
+        });
     }
 
-    std::pair<std::shared_ptr<Player::IPlayer>, BoardPlayerType> getGuestPlayer() {
-        return {playerManagerPtr_->getGuestClient(),
-                playerManagerPtr_->getGuestClient()->get_player_type()};
+    PlayerKind getCurrentPlayerKind() const {
+        return is_host_turn_ ? host_player_kind_ : guest_player_kind_;
     }
 
-    std::pair<std::shared_ptr<Player::IPlayer>, BoardPlayerType> getCurrentPlayer() {
+    std::pair<Player::IPlayer *, BoardPlayerType> getCurrentPlayer() const {
         if (is_host_turn_) {
             LOG_V("Host turn");
-            return getHostPlayer();
+            return {host_player_, host_player_type_};
         } else {
             LOG_V("Guest turn");
-            return getGuestPlayer();
+            return {guest_player_, guest_player_type_};
         }
     }
 };
 
-GameEngine::GameEngine(std::shared_ptr<PlayerManager::PlayerManager> playerManagerPtr, size_t board_size) {
-    impl_ = std::make_unique<GameEngineImpl>(playerManagerPtr, board_size);
+GameEngine::GameEngine(std::shared_ptr<PlayerManager::PlayerManager> playerManagerPtr, size_t board_size,
+                       std::shared_ptr<GameRecord::IGameRecordWriter> record_writer) {
+    impl_ = std::make_unique<GameEngineImpl>(playerManagerPtr, board_size, std::move(record_writer));
 }
 
 }   // namespace GameEngine
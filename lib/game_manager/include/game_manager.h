@@ -6,6 +6,8 @@
 #include "player_type.h"
 #include "board.h"
 #include "player_interface.h"
+#include "game_engine.h"
+#include "task.h"
 
 namespace GameManager {
 
@@ -19,6 +21,12 @@ public:
     virtual ~IGameManager() = default;
     virtual void startGame() = 0;
     virtual void stopGame() = 0;
+    // Game loop as a coroutine, the session only occupies a thread while a player is moving
+    virtual Coro::Task<void> playAsync() = 0;
+    // Engine state for resuming the session elsewhere, take it while no move is being processed
+    virtual GameEngine::Snapshot snapshot() const = 0;
+    // Observe the session's engine, add listeners before the game is started
+    virtual void addEventListener(std::shared_ptr<GameEngine::IGameEventListener> listener) = 0;
 
 private:
 };
@@ -29,6 +37,10 @@ class GameManager {
 public:
     GameManager();
     explicit GameManager(std::shared_ptr<Player::IPlayer> player);
+    // Resume a session from a snapshot taken by snapshot(), throws on an invalid snapshot
+    GameManager(std::shared_ptr<Player::IPlayer> player, const GameEngine::Snapshot &snapshot);
+    // Session between players set up by the caller, e.g. two matched remote players
+    explicit GameManager(std::shared_ptr<PlayerManager::PlayerManager> player_manager);
     ~GameManager() = default;
     void startGame() {
         impl_->startGame();
@@ -38,6 +50,18 @@ public:
         impl_->stopGame();
     }
 
+    Coro::Task<void> playAsync() {
+        return impl_->playAsync();
+    }
+
+    GameEngine::Snapshot snapshot() const {
+        return impl_->snapshot();
+    }
+
+    void addEventListener(std::shared_ptr<GameEngine::IGameEventListener> listener) {
+        impl_->addEventListener(std::move(listener));
+    }
+
 private:
     std::unique_ptr<IGameManager> impl_;
 };
@@ -4,9 +4,13 @@
 #include "game_result_type.h"
 #include "player_manager.h"
 #include "log.h"
+#include "trace.h"
 
 #include <cstdlib>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <stop_token>
 #include <thread>
 #include <memory>
 #include <mutex>
@@ -14,9 +18,13 @@
 namespace GameManager
 {
 
+// Pause between two moves of the game thread
+constexpr std::chrono::milliseconds kMoveInterval{100};
+
 class GameManagerImpl : public IGameManager {
 private:
     mutable std::mutex game_thread_mutex_;
+    std::condition_variable_any game_thread_cv_;
 
 public:
     explicit GameManagerImpl(std::shared_ptr<Player::IPlayer> host_player = nullptr) {
@@ -25,10 +33,30 @@ public:
         LOG_D("Game manager created");
     }
 
+    explicit GameManagerImpl(std::shared_ptr<PlayerManager::PlayerManager> player_manager) :
+            player_manager_(std::move(player_manager)) {
+        validatePlayerManager();
+        createGameEngine();
+        LOG_D("Game manager created");
+    }
+
+    GameManagerImpl(std::shared_ptr<Player::IPlayer> host_player, const GameEngine::Snapshot &snapshot) {
+        createPlayerManager(host_player);
+        createGameEngine();
+        if (game_engine_->restore(snapshot) != GameEngine::GameEngineError::kOK) {
+            LOG_E("Game engine snapshot is invalid");
+            throw std::runtime_error("Game engine snapshot is invalid");
+        }
+        round_counter_ = game_engine_->getRoundsPlayed() + 1U;
+        last_score_ = game_engine_->getScore();
+        LOG_D("Game manager restored from snapshot");
+    }
+
     ~GameManagerImpl() {
         LOG_D("Wait for game thread to stop");
+        // The search or wait in progress sees the stop request, so the join below is short
+        stopGame();
         if (game_thread_.joinable()) {
-            game_thread_stopped_ = true;
             game_thread_.join();
         }
         LOG_D("Game manager destroyed");
@@ -36,12 +64,33 @@ public:
 
     void startGame() override {
         LOG_D("Game Manager starting game");
-        game_thread_ = std::thread(&GameManagerImpl::gameThraedLoop, this);
+        game_thread_ = std::jthread([this](std::stop_token stop) {
+            gameThreadLoop(stop);
+        });
     }
 
     void stopGame() override {
         LOG_D("Game Manager stopping game");
-        game_thread_stopped_ = true;
+        stop_source_.request_stop();
+        game_thread_.request_stop();
+    }
+
+    GameEngine::Snapshot snapshot() const override {
+        return game_engine_->snapshot();
+    }
+
+    void addEventListener(std::shared_ptr<GameEngine::IGameEventListener> listener) override {
+        game_engine_->addEventListener(std::move(listener));
+    }
+
+    Coro::Task<void> playAsync() override {
+        LOG_D("Game Manager starting asynchronous game loop");
+        const auto stop = stop_source_.get_token();
+        while (!stop.stop_requested()) {
+            const auto game_process_resolutes = co_await game_engine_->processGameAsync(stop);
+            handleProcessResult(game_process_resolutes);
+        }
+        LOG_D("Asynchronous game loop stopped");
     }
 
 private:
@@ -51,8 +100,9 @@ private:
     size_t round_counter_ = 1;
     std::pair<int, int> last_score_ = {0, 0};
 
-    std::thread game_thread_;
-    std::atomic<bool> game_thread_stopped_ = false;
+    // Stops the asynchronous session, the game thread has the stop source of its jthread
+    std::stop_source stop_source_;
+    std::jthread game_thread_;
     std::atomic<bool> is_game_finished = false;
 
     void createPlayerManager(std::shared_ptr<Player::IPlayer> host_player) {
@@ -62,6 +112,10 @@ private:
             LOG_D("Creating player manager with bot player");
             player_manager_ = std::make_shared<PlayerManager::PlayerManager>(PlayerManager::TypeOfGuestPlayer::Bot);
         }
+        validatePlayerManager();
+    }
+
+    void validatePlayerManager() {
         if (player_manager_ == nullptr) {
             LOG_E("Player manager creation failed");
             throw std::runtime_error("Player manager creation failed");
@@ -82,32 +136,36 @@ private:
         LOG_D("Game engine created");
     }
 
-    void gameThraedLoop() {
-        while (true) {
-            if (game_thread_stopped_) {
-                LOG_D("Game thread stopped");
-                break;
+    void handleProcessResult(GameEngine::GameEngineError game_process_resolutes) {
+        LOG_D("Game result: {}", static_cast<int>(game_process_resolutes));
+        if (game_process_resolutes == GameEngine::GameEngineError::kGameFinished) {
+            const auto game_score = game_engine_->getScore();
+            LOG_D("Game finished. Resoluts: Host: {}, Guest: {}", game_score.first, game_score.second);
+            ++round_counter_;
+            auto round_result = RoundResult::Draw;
+            if (game_score.first > last_score_.first) {
+                round_result = RoundResult::HostWin;
+            } else if (game_score.second > last_score_.second) {
+                round_result = RoundResult::GuestWin;
             }
-            const auto game_process_resolutes = game_engine_->processGame();
-            LOG_D("Game result: {}", static_cast<int>(game_process_resolutes));
-            if (game_process_resolutes == GameEngine::GameEngineError::kGameFinished) {
-                const auto game_score = game_engine_->getScore();
-                LOG_D("Game finished. Resoluts: Host: {}, Guest: {}", game_score.first, game_score.second);
-                ++round_counter_;
-                auto round_result = RoundResult::Draw;
-                if (game_score.first > last_score_.first) {
-                    round_result = RoundResult::HostWin;
-                } else if (game_score.second > last_score_.second) {
-                    round_result = RoundResult::GuestWin;
-                }
-                last_score_ = game_score;
-                player_manager_->notifyPlayersRoundEnd(round_result, game_score, round_counter_, game_engine_->getBoard());
-                game_engine_->resetGame();
-            }
-            // Sleep for a short duration to avoid busy waiting
-            // TODO: change this mechanism to use condition variable
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            last_score_ = game_score;
+            player_manager_->notifyPlayersRoundEnd(round_result, game_score, round_counter_, game_engine_->getBoard());
+            game_engine_->resetGame();
+        }
+    }
+
+    void gameThreadLoop(std::stop_token stop) {
+        Trace::setThreadName("game");
+        while (!stop.stop_requested()) {
+            const auto game_process_resolutes = game_engine_->processGame(stop);
+            handleProcessResult(game_process_resolutes);
+            // Pace the moves, a stop request ends the pause right away
+            std::unique_lock<std::mutex> lock(game_thread_mutex_);
+            game_thread_cv_.wait_for(lock, stop, kMoveInterval, [] {
+                return false;
+            });
         }
+        LOG_D("Game thread stopped");
     }
 };
 
@@ -115,4 +173,10 @@ GameManager::GameManager() : impl_(std::make_unique<GameManagerImpl>()) {}
 
 GameManager::GameManager(std::shared_ptr<Player::IPlayer> player) : impl_(std::make_unique<GameManagerImpl>(player)) {}
 
+GameManager::GameManager(std::shared_ptr<Player::IPlayer> player, const GameEngine::Snapshot &snapshot) :
+    impl_(std::make_unique<GameManagerImpl>(player, snapshot)) {}
+
+GameManager::GameManager(std::shared_ptr<PlayerManager::PlayerManager> player_manager) :
+    impl_(std::make_unique<GameManagerImpl>(std::move(player_manager))) {}
+
 } // namespace GameManager
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "game_result_type.h"
+#include "player_type.h"
+#include "varint.h"
+
+namespace GameRecord {
+
+// File layout:
+//   file header: "TTTR" magic, version byte, 3 reserved bytes
+//   records:     flags byte, board size byte, varint move count,
+//                [varint payload size, only for varint encoded moves], payload
+// Moves are cell indices (row * board_size + col) in play order. Boards with up to 16 cells
+// store two moves per byte, larger boards store one varint per move.
+constexpr std::array<char, 4> kFileMagic = {'T', 'T', 'T', 'R'};
+constexpr uint8_t kFormatVersion = 1U;
+constexpr size_t kFileHeaderSize = 8U;
+
+// Flags byte bit layout
+constexpr uint8_t kFlagResultMask = 0x03U;      // RoundResult value
+constexpr uint8_t kFlagHostStarted = 0x04U;     // host made the first move
+constexpr uint8_t kFlagHostIsO = 0x08U;         // host plays O
+constexpr uint8_t kFlagVarintMoves = 0x10U;     // move payload is varint encoded
+
+constexpr size_t kMaxNibbleCells = 16U;
+
+// One finished game, the moves are borrowed from the caller
+struct GameRecordData {
+    uint8_t board_size = 0;
+    RoundResult result = RoundResult::Draw;
+    bool host_started = true;
+    BoardPlayerType host_player_type = BoardPlayerType::X;
+    std::span<const uint16_t> moves;
+};
+
+class IGameRecordWriter {
+public:
+    virtual ~IGameRecordWriter() = default;
+    virtual void append(const GameRecordData &record) = 0;
+    // Throws std::runtime_error when records could not be written
+    virtual void flush() = 0;
+};
+
+class GameRecordWriterImpl;
+
+// Buffered append-only writer, records are written to the file in large batches. An existing file
+// must have a valid header, a torn last record left by a crash is cut off on open. After the first
+// failed write the file is cut back to its last full record and further appends are dropped.
+class GameRecordWriter : public IGameRecordWriter {
+public:
+    // Throws std::runtime_error when the file cannot be opened or is no game record file
+    explicit GameRecordWriter(const std::string &path);
+    ~GameRecordWriter() override = default;
+
+    void append(const GameRecordData &record) override {
+        impl_->append(record);
+    }
+
+    void flush() override {
+        impl_->flush();
+    }
+
+private:
+    std::unique_ptr<IGameRecordWriter> impl_;
+};
+
+// Zero-copy view of a single record inside a mapped file
+class RecordView {
+public:
+    RecordView() = default;
+    RecordView(uint8_t flags, uint8_t board_size, size_t move_count, std::span<const uint8_t> payload):
+            flags_(flags), board_size_(board_size), move_count_(move_count), payload_(payload) {}
+
+    RoundResult result() const {
+        return static_cast<RoundResult>(flags_ & kFlagResultMask);
+    }
+
+    bool hostStarted() const {
+        return (flags_ & kFlagHostStarted) != 0U;
+    }
+
+    BoardPlayerType hostPlayerType() const {
+        return (flags_ & kFlagHostIsO) != 0U ? BoardPlayerType::O : BoardPlayerType::X;
+    }
+
+    uint8_t boardSize() const {
+        return board_size_;
+    }
+
+    size_t moveCount() const {
+        return move_count_;
+    }
+
+    // Call f(cell_index) for every move in play order
+    template <typename Function>
+    void forEachMove(Function &&f) const {
+        if ((flags_ & kFlagVarintMoves) == 0U) {
+            for (size_t i = 0; i < move_count_; ++i) {
+                const auto byte = payload_[i / 2U];
+                f(static_cast<uint16_t>((i % 2U == 0U) ? (byte & 0x0FU) : (byte >> 4U)));
+            }
+            return;
+        }
+        size_t offset = 0;
+        for (size_t i = 0; i < move_count_; ++i) {
+            f(static_cast<uint16_t>(decodeVarint(payload_, offset).value_or(0U)));
+        }
+    }
+
+private:
+    uint8_t flags_ = 0;
+    uint8_t board_size_ = 0;
+    size_t move_count_ = 0;
+    std::span<const uint8_t> payload_;
+};
+
+// Memory mapped reader, iterating only decodes the few header bytes of each record
+class GameRecordReader {
+public:
+    explicit GameRecordReader(const std::string &path);
+    ~GameRecordReader();
+    GameRecordReader(const GameRecordReader &) = delete;
+    GameRecordReader &operator=(const GameRecordReader &) = delete;
+
+    class Iterator {
+    public:
+        Iterator(std::span<const uint8_t> data, size_t offset);
+
+        const RecordView &operator*() const {
+            return record_;
+        }
+
+        const RecordView *operator->() const {
+            return &record_;
+        }
+
+        Iterator &operator++() {
+            offset_ = next_offset_;
+            decode();
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return offset_ == other.offset_;
+        }
+
+    private:
+        std::span<const uint8_t> data_;
+        size_t offset_;
+        size_t next_offset_ = 0;
+        RecordView record_;
+
+        void decode();
+    };
+
+    Iterator begin() const {
+        return Iterator(data_, kFileHeaderSize);
+    }
+
+    // A truncated record at the end of the file (e.g. after a crash) ends the iteration
+    Iterator end() const {
+        return Iterator(data_, data_.size());
+    }
+
+private:
+    std::span<const uint8_t> data_;
+};
+
+} // namespace GameRecord
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace GameRecord {
+
+// Maximum number of bytes used by a LEB128 encoded 64-bit value
+constexpr size_t kMaxVarintSize = 10U;
+
+// Write value as LEB128 into out, returns number of bytes used
+inline size_t encodeVarint(uint64_t value, uint8_t *out) {
+    size_t size = 0;
+    while (value >= 0x80U) {
+        out[size++] = static_cast<uint8_t>(value | 0x80U);
+        value >>= 7U;
+    }
+    out[size++] = static_cast<uint8_t>(value);
+    return size;
+}
+
+// Read a LEB128 value from the front of data and advance offset, nullopt when truncated
+inline std::optional<uint64_t> decodeVarint(std::span<const uint8_t> data, size_t &offset) {
+    uint64_t value = 0;
+    for (unsigned shift = 0; offset < data.size() && shift < 64U; shift += 7U) {
+        const auto byte = data[offset++];
+        value |= static_cast<uint64_t>(byte & 0x7FU) << shift;
+        if ((byte & 0x80U) == 0U) {
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace GameRecord
@@ -0,0 +1,285 @@
+#include "game_record.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace GameRecord {
+
+// Buffer is written to the file once it grows past this size
+constexpr size_t kWriteBufferSize = 64U * 1024U;
+// Flags, board size, move count and payload size
+constexpr size_t kMaxRecordHeaderSize = 2U + 2U * kMaxVarintSize;
+
+namespace {
+
+bool isValidHeader(std::span<const uint8_t> data) {
+    return data.size() >= kFileHeaderSize && std::equal(kFileMagic.begin(), kFileMagic.end(), data.begin()) &&
+           data[kFileMagic.size()] == kFormatVersion;
+}
+
+// Decodes the record at offset and moves offset past it, empty for a truncated record
+std::optional<RecordView> decodeRecord(std::span<const uint8_t> data, size_t &offset) {
+    if (offset + 2U > data.size()) {
+        return std::nullopt;
+    }
+    size_t position = offset;
+    const auto flags = data[position++];
+    const auto board_size = data[position++];
+    const auto move_count = decodeVarint(data, position);
+    if (!move_count.has_value()) {
+        return std::nullopt;
+    }
+    size_t payload_size = (*move_count + 1U) / 2U;
+    if ((flags & kFlagVarintMoves) != 0U) {
+        const auto encoded_size = decodeVarint(data, position);
+        if (!encoded_size.has_value()) {
+            return std::nullopt;
+        }
+        payload_size = *encoded_size;
+    }
+    if (payload_size > data.size() - position) {
+        return std::nullopt;
+    }
+    offset = position + payload_size;
+    return RecordView(flags, board_size, *move_count, data.subspan(position, payload_size));
+}
+
+// End of the last complete record of an existing file, empty when it is no game record file
+std::optional<size_t> completeRecordsSize(int fd, size_t size) {
+    if (size < kFileHeaderSize) {
+        LOG_E("Game record file is too short");
+        return std::nullopt;
+    }
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOG_E("Cannot map game record file: {}", std::strerror(errno));
+        return std::nullopt;
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    const std::span<const uint8_t> data(static_cast<const uint8_t *>(mapping), size);
+    std::optional<size_t> valid_size;
+    if (isValidHeader(data)) {
+        size_t offset = kFileHeaderSize;
+        while (decodeRecord(data, offset).has_value()) {
+        }
+        valid_size = offset;
+    } else {
+        LOG_E("Invalid game record file header");
+    }
+    ::munmap(mapping, size);
+    return valid_size;
+}
+
+} // namespace
+
+class GameRecordWriterImpl : public IGameRecordWriter {
+public:
+    explicit GameRecordWriterImpl(const std::string &path) {
+        // Read access for checking the records left by an earlier run
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            LOG_E("Cannot open game record file {}: {}", path, std::strerror(errno));
+            throw std::runtime_error("Cannot open game record file");
+        }
+        buffer_.reserve(kWriteBufferSize + kMaxRecordHeaderSize);
+        struct stat file_stat {};
+        if (::fstat(fd_, &file_stat) != 0) {
+            LOG_E("Cannot stat game record file {}: {}", path, std::strerror(errno));
+            ::close(fd_);
+            throw std::runtime_error("Cannot stat game record file");
+        }
+        file_size_ = static_cast<size_t>(file_stat.st_size);
+        if (file_size_ == 0U) {
+            buffer_.insert(buffer_.end(), kFileMagic.begin(), kFileMagic.end());
+            buffer_.push_back(kFormatVersion);
+            buffer_.resize(kFileHeaderSize, 0U);
+        } else {
+            // The reader cannot resync after a torn record, so one left by a crash is cut off
+            // before anything is appended behind it
+            const auto valid_size = completeRecordsSize(fd_, file_size_);
+            if (!valid_size.has_value()) {
+                ::close(fd_);
+                throw std::runtime_error("Invalid game record file " + path);
+            }
+            if (*valid_size < file_size_) {
+                LOG_W("Cutting {} bytes of torn game record tail in {}", file_size_ - *valid_size, path);
+                if (::ftruncate(fd_, static_cast<off_t>(*valid_size)) != 0) {
+                    LOG_E("Cannot truncate game record file {}: {}", path, std::strerror(errno));
+                    ::close(fd_);
+                    throw std::runtime_error("Cannot truncate game record file");
+                }
+                file_size_ = *valid_size;
+            }
+        }
+        LOG_D("Game record writer opened {}", path);
+    }
+
+    ~GameRecordWriterImpl() override {
+        {
+            std::scoped_lock<std::mutex> lock(buffer_mutex_);
+            writeBuffer();
+        }
+        ::close(fd_);
+    }
+
+    void append(const GameRecordData &record) override {
+        const auto cells = static_cast<size_t>(record.board_size) * record.board_size;
+        const bool varint_moves = cells > kMaxNibbleCells;
+
+        uint8_t flags = static_cast<uint8_t>(record.result) & kFlagResultMask;
+        if (record.host_started) {
+            flags |= kFlagHostStarted;
+        }
+        if (record.host_player_type == BoardPlayerType::O) {
+            flags |= kFlagHostIsO;
+        }
+        if (varint_moves) {
+            flags |= kFlagVarintMoves;
+        }
+
+        std::scoped_lock<std::mutex> lock(buffer_mutex_);
+        // The file ends with the last full record written before the failure, later games are dropped
+        if (failed_) {
+            return;
+        }
+        uint8_t header[kMaxRecordHeaderSize];
+        size_t header_size = 0;
+        header[header_size++] = flags;
+        header[header_size++] = record.board_size;
+        header_size += encodeVarint(record.moves.size(), header + header_size);
+
+        if (!varint_moves) {
+            buffer_.insert(buffer_.end(), header, header + header_size);
+            for (size_t i = 0; i < record.moves.size(); i += 2U) {
+                auto byte = static_cast<uint8_t>(record.moves[i] & 0x0FU);
+                if (i + 1U < record.moves.size()) {
+                    byte |= static_cast<uint8_t>((record.moves[i + 1U] & 0x0FU) << 4U);
+                }
+                buffer_.push_back(byte);
+            }
+        } else {
+            uint8_t payload[kMaxVarintSize];
+            size_t payload_size = 0;
+            for (const auto move : record.moves) {
+                payload_size += encodeVarint(move, payload);
+            }
+            header_size += encodeVarint(payload_size, header + header_size);
+            buffer_.insert(buffer_.end(), header, header + header_size);
+            for (const auto move : record.moves) {
+                const auto size = encodeVarint(move, payload);
+                buffer_.insert(buffer_.end(), payload, payload + size);
+            }
+        }
+
+        if (buffer_.size() >= kWriteBufferSize) {
+            writeBuffer();
+        }
+    }
+
+    void flush() override {
+        std::scoped_lock<std::mutex> lock(buffer_mutex_);
+        writeBuffer();
+        if (failed_) {
+            throw std::runtime_error("Game record write failed");
+        }
+    }
+
+private:
+    int fd_ = -1;
+    std::mutex buffer_mutex_;
+    std::vector<uint8_t> buffer_;
+    size_t file_size_ = 0;      // end of the last full record in the file
+    bool failed_ = false;
+
+    // The buffer only holds whole records, a failed write cuts the file back to where it started
+    void writeBuffer() {
+        if (failed_) {
+            buffer_.clear();
+            return;
+        }
+        size_t written = 0;
+        while (written < buffer_.size()) {
+            const auto result = ::write(fd_, buffer_.data() + written, buffer_.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                const auto error = errno;
+                LOG_E("Game record write failed, no further games are recorded: {}", std::strerror(error));
+                failed_ = true;
+                if (written > 0U && ::ftruncate(fd_, static_cast<off_t>(file_size_)) != 0) {
+                    LOG_E("Cannot truncate game record file to its last full record: {}", std::strerror(errno));
+                }
+                break;
+            }
+            written += static_cast<size_t>(result);
+        }
+        if (!failed_) {
+            file_size_ += buffer_.size();
+        }
+        buffer_.clear();
+    }
+};
+
+GameRecordWriter::GameRecordWriter(const std::string &path) :
+    impl_(std::make_unique<GameRecordWriterImpl>(path)) {
+}
+
+GameRecordReader::GameRecordReader(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_E("Cannot open game record file {}: {}", path, std::strerror(errno));
+        throw std::runtime_error("Cannot open game record file");
+    }
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0 || static_cast<size_t>(file_stat.st_size) < kFileHeaderSize) {
+        ::close(fd);
+        throw std::runtime_error("Game record file is too short");
+    }
+    const auto size = static_cast<size_t>(file_stat.st_size);
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        LOG_E("Cannot map game record file {}: {}", path, std::strerror(errno));
+        throw std::runtime_error("Cannot map game record file");
+    }
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    data_ = std::span<const uint8_t>(static_cast<const uint8_t *>(mapping), size);
+
+    if (!isValidHeader(data_)) {
+        ::munmap(mapping, size);
+        throw std::runtime_error("Invalid game record file header");
+    }
+}
+
+GameRecordReader::~GameRecordReader() {
+    ::munmap(const_cast<uint8_t *>(data_.data()), data_.size());
+}
+
+GameRecordReader::Iterator::Iterator(std::span<const uint8_t> data, size_t offset):
+        data_(data), offset_(offset) {
+    decode();
+}
+
+void GameRecordReader::Iterator::decode() {
+    size_t position = offset_;
+    const auto record = decodeRecord(data_, position);
+    if (!record.has_value()) {
+        offset_ = data_.size();
+        return;
+    }
+    record_ = *record;
+    next_offset_ = position;
+}
+
+} // namespace GameRecord
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "player_remote.h"
+
+namespace GameServer {
+
+struct GameServerConfig {
+    std::string address = "0.0.0.0";
+    uint16_t port = 7777;       // 0 picks a free port, see GameServer::port()
+    size_t shards = 1;          // event loop threads, each with its own SO_REUSEPORT listener
+    size_t max_connections_per_shard = 4096;
+    std::chrono::milliseconds move_timeout = Player::kDefaultRemoteMoveTimeout;
+    // Write-ahead journal of all sessions, empty disables it. Sessions found in it on start
+    // belonged to players who are gone, they are reported and the journal starts over.
+    std::string journal_path;
+};
+
+struct GameServerStats {
+    size_t connections_accepted = 0;
+    size_t connections_rejected = 0;    // shard was at max_connections_per_shard
+    size_t active_connections = 0;
+    size_t sessions_started = 0;
+    size_t sessions_finished = 0;
+    size_t spectators_attached = 0;
+    size_t journal_records = 0;
+    size_t journal_commits = 0;
+    bool journal_failed = false;
+    size_t journal_dropped = 0;
+};
+
+class IGameServer {
+public:
+    virtual ~IGameServer() = default;
+    virtual void start() = 0;
+    // Ends all sessions and joins the event loop threads
+    virtual void stop() = 0;
+    virtual uint16_t port() const = 0;
+    virtual GameServerStats stats() const = 0;
+};
+
+// Front end for remote players. Every shard thread runs an epoll loop over its listener and
+// connections. Clients start with Join, joined connections are paired in arrival order and
+// each pair plays as a GameManager session driven by playAsync(), so moves decoded by the loop
+// resume the sessions directly. Clients sending Watch with the session id from Hello become
+// spectators of that session, on whichever shard runs it. A session ends when either player
+// disconnects, all its connections are closed then.
+class GameServer {
+public:
+    // Binds the listening sockets, throws std::runtime_error on failure
+    explicit GameServer(GameServerConfig config);
+    ~GameServer() = default;
+
+    void start() {
+        impl_->start();
+    }
+
+    void stop() {
+        impl_->stop();
+    }
+
+    uint16_t port() const {
+        return impl_->port();
+    }
+
+    GameServerStats stats() const {
+        return impl_->stats();
+    }
+
+private:
+    std::unique_ptr<IGameServer> impl_;
+};
+
+} // namespace GameServer
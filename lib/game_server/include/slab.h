@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace GameServer {
+
+// Fixed capacity object pool. All slots are allocated up front and objects are constructed in
+// place, so taking and releasing an entry never touches the heap and indices stay stable.
+template <typename T>
+class Slab {
+public:
+    explicit Slab(size_t capacity) : slots_(capacity) {
+        free_.reserve(capacity);
+        for (size_t index = capacity; index > 0U; --index) {
+            free_.push_back(static_cast<uint32_t>(index - 1U));
+        }
+    }
+
+    Slab(const Slab &) = delete;
+    Slab &operator=(const Slab &) = delete;
+
+    // Returns std::nullopt when the slab is full
+    template <typename... Args>
+    std::optional<uint32_t> allocate(Args &&...args) {
+        if (free_.empty()) {
+            return std::nullopt;
+        }
+        const auto index = free_.back();
+        free_.pop_back();
+        slots_[index].emplace(std::forward<Args>(args)...);
+        return index;
+    }
+
+    void release(uint32_t index) {
+        slots_[index].reset();
+        free_.push_back(index);
+    }
+
+    T &operator[](uint32_t index) {
+        return *slots_[index];
+    }
+
+    bool contains(uint32_t index) const {
+        return index < slots_.size() && slots_[index].has_value();
+    }
+
+    size_t size() const {
+        return slots_.size() - free_.size();
+    }
+
+    size_t capacity() const {
+        return slots_.size();
+    }
+
+    template <typename Function>
+    void forEach(Function &&function) {
+        for (size_t index = 0; index < slots_.size(); ++index) {
+            if (slots_[index].has_value()) {
+                function(static_cast<uint32_t>(index), *slots_[index]);
+            }
+        }
+    }
+
+private:
+    std::vector<std::optional<T>> slots_;
+    std::vector<uint32_t> free_;
+};
+
+} // namespace GameServer
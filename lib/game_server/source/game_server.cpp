@@ -0,0 +1,658 @@
+#include "game_server.h"
+#include "game_manager.h"
+#include "journal.h"
+#include "mpsc_ring_buffer.h"
+#include "player_manager.h"
+#include "remote_socket.h"
+#include "slab.h"
+#include "spectator_hub.h"
+#include "task.h"
+#include "wire_protocol.h"
+#include "log.h"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <optional>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace GameServer
+{
+
+namespace {
+
+constexpr size_t kMaxEvents = 256U;
+// Move deadlines are checked on this period
+constexpr std::chrono::milliseconds kTimeoutTick{50};
+constexpr uint64_t kListenTag = UINT64_MAX;
+constexpr uint64_t kWakeTag = UINT64_MAX - 1U;
+constexpr uint32_t kReadEvents = EPOLLIN | EPOLLRDHUP;
+// Spectators are only written to by the hub, edge triggered EPOLLOUT tells when a full socket drained
+constexpr uint32_t kSpectatorEvents = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+constexpr uint32_t kNoSession = UINT32_MAX;
+// Session ids given to clients carry the shard in the top bits
+constexpr uint32_t kSessionIndexBits = 24U;
+constexpr uint32_t kSessionIndexMask = (1U << kSessionIndexBits) - 1U;
+constexpr size_t kHandoffQueueSize = 256U;
+
+enum class Role : uint8_t {
+    Pending,    // waiting for Join or Watch
+    Waiting,    // joined, no partner yet
+    Player,
+    Spectator
+};
+
+struct Connection {
+    explicit Connection(int socket_fd) : fd(socket_fd) {}
+
+    int fd;
+    Role role = Role::Pending;
+    // Created once the connection is matched, it owns the socket from then on
+    std::optional<Player::PlayerRemote> player;
+    uint32_t session = kNoSession;
+    uint32_t registered_events = kReadEvents;
+    // First frame of a pending connection
+    std::array<uint8_t, Wire::kMaxFrameSize> input {};
+    size_t input_size = 0;
+};
+
+struct Session {
+    Session(uint32_t host_index, uint32_t guest_index) : host(host_index), guest(guest_index) {}
+
+    uint32_t host;
+    uint32_t guest;
+    std::unique_ptr<GameManager::GameManager> game_manager;
+    std::shared_ptr<Spectator::SpectatorHub> spectators;
+    std::vector<uint32_t> spectator_connections;
+    bool closing = false;   // queued for teardown
+    bool finished = false;  // playAsync() returned
+};
+
+// Spectator socket accepted by one shard for a session of another
+struct SpectatorHandoff {
+    int fd = -1;
+    uint32_t session = 0;
+};
+
+[[noreturn]] void throwSystemError(const char *what) {
+    LOG_E("{} failed: {}", what, std::strerror(errno));
+    throw std::runtime_error(std::string(what) + " failed: " + std::strerror(errno));
+}
+
+} // namespace
+
+class Shard {
+public:
+    Shard(const GameServerConfig &config, uint32_t shard_index, int listen_fd,
+          std::shared_ptr<Journal::JournalWriter> journal) :
+            shard_index_(shard_index),
+            journal_(std::move(journal)),
+            move_timeout_(config.move_timeout),
+            listen_fd_(listen_fd),
+            connections_(config.max_connections_per_shard),
+            sessions_(config.max_connections_per_shard / 2U + 1U) {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (epoll_fd_ < 0 || wake_fd_ < 0) {
+            close(listen_fd_);
+            throwSystemError("epoll setup");
+        }
+        const auto flags = fcntl(listen_fd_, F_GETFL);
+        fcntl(listen_fd_, F_SETFL, flags | O_NONBLOCK);
+        addToEpoll(listen_fd_, EPOLLIN, kListenTag);
+        addToEpoll(wake_fd_, EPOLLIN, kWakeTag);
+        closing_.reserve(sessions_.capacity());
+    }
+
+    ~Shard() {
+        stop();
+        close(listen_fd_);
+        close(wake_fd_);
+        close(epoll_fd_);
+    }
+
+    void setPeers(std::vector<Shard *> peers) {
+        peers_ = std::move(peers);
+    }
+
+    void start() {
+        thread_ = std::thread(&Shard::run, this);
+    }
+
+    // Called from other shards, hands over a spectator socket for one of this shard's sessions
+    bool adoptSpectator(int socket_fd, uint32_t session_index) {
+        if (!handoffs_.tryPush(SpectatorHandoff{socket_fd, session_index})) {
+            return false;
+        }
+        wake();
+        return true;
+    }
+
+    void stop() {
+        stopping_.store(true, std::memory_order_release);
+        wake();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    void addStats(GameServerStats &stats) const {
+        stats.connections_accepted += connections_accepted_.load(std::memory_order_relaxed);
+        stats.connections_rejected += connections_rejected_.load(std::memory_order_relaxed);
+        stats.active_connections += active_connections_.load(std::memory_order_relaxed);
+        stats.sessions_started += sessions_started_.load(std::memory_order_relaxed);
+        stats.sessions_finished += sessions_finished_.load(std::memory_order_relaxed);
+        stats.spectators_attached += spectators_attached_.load(std::memory_order_relaxed);
+    }
+
+private:
+    uint32_t shard_index_;
+    std::shared_ptr<Journal::JournalWriter> journal_;
+    std::chrono::milliseconds move_timeout_;
+    int listen_fd_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> stopping_ = false;
+    std::vector<Shard *> peers_;
+    Concurrency::MpscRingBuffer<SpectatorHandoff, kHandoffQueueSize> handoffs_;
+
+    Slab<Connection> connections_;
+    Slab<Session> sessions_;
+    std::optional<uint32_t> waiting_connection_;
+    std::vector<uint32_t> closing_;
+
+    std::atomic<size_t> connections_accepted_ = 0;
+    std::atomic<size_t> connections_rejected_ = 0;
+    std::atomic<size_t> active_connections_ = 0;
+    std::atomic<size_t> sessions_started_ = 0;
+    std::atomic<size_t> sessions_finished_ = 0;
+    std::atomic<size_t> spectators_attached_ = 0;
+
+    void wake() {
+        const uint64_t value = 1;
+        std::ignore = write(wake_fd_, &value, sizeof(value));
+    }
+
+    void addToEpoll(int fd, uint32_t events, uint64_t tag) {
+        epoll_event event {.events = events, .data = {.u64 = tag}};
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            throwSystemError("epoll_ctl");
+        }
+    }
+
+    void run() {
+        LOG_D("Game server shard started");
+        std::array<epoll_event, kMaxEvents> events;
+        auto next_tick = std::chrono::steady_clock::now() + kTimeoutTick;
+        while (!stopping_.load(std::memory_order_acquire)) {
+            const auto count = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()),
+                                          static_cast<int>(kTimeoutTick.count()));
+            if (count < 0 && errno != EINTR) {
+                LOG_E("epoll_wait failed: {}", std::strerror(errno));
+                break;
+            }
+            for (int i = 0; i < count; ++i) {
+                const auto tag = events[i].data.u64;
+                if (tag == kListenTag) {
+                    acceptConnections();
+                } else if (tag == kWakeTag) {
+                    uint64_t value = 0;
+                    std::ignore = read(wake_fd_, &value, sizeof(value));
+                    adoptHandoffs();
+                } else {
+                    handleConnection(static_cast<uint32_t>(tag), events[i].events);
+                }
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= next_tick) {
+                checkTimeouts(now);
+                next_tick = now + kTimeoutTick;
+            }
+            closeSessions();
+        }
+        shutdown();
+        LOG_D("Game server shard stopped");
+    }
+
+    void acceptConnections() {
+        while (true) {
+            const int socket_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (socket_fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    LOG_E("accept failed: {}", std::strerror(errno));
+                }
+                return;
+            }
+            const auto index = connections_.allocate(socket_fd);
+            if (!index.has_value()) {
+                LOG_W("Connection limit reached, rejecting connection");
+                connections_rejected_.fetch_add(1U, std::memory_order_relaxed);
+                close(socket_fd);
+                continue;
+            }
+            addToEpoll(socket_fd, kReadEvents, *index);
+            connections_accepted_.fetch_add(1U, std::memory_order_relaxed);
+            active_connections_.fetch_add(1U, std::memory_order_relaxed);
+        }
+    }
+
+    void adoptHandoffs() {
+        while (const auto handoff = handoffs_.tryPop()) {
+            const auto index = connections_.allocate(handoff->fd);
+            if (!index.has_value()) {
+                connections_rejected_.fetch_add(1U, std::memory_order_relaxed);
+                close(handoff->fd);
+                continue;
+            }
+            addToEpoll(handoff->fd, kReadEvents, *index);
+            active_connections_.fetch_add(1U, std::memory_order_relaxed);
+            attachSpectator(*index, handoff->session);
+        }
+    }
+
+    void handleConnection(uint32_t index, uint32_t events) {
+        if (!connections_.contains(index)) {
+            return;
+        }
+        auto &connection = connections_[index];
+        switch (connection.role) {
+            case Role::Pending:
+                readFirstFrame(index);
+                break;
+            case Role::Waiting:
+                // The peer has nothing to say before its first move request
+                if (!drainInput(connection.fd)) {
+                    LOG_D("Waiting connection closed");
+                    waiting_connection_.reset();
+                    closeConnection(index);
+                }
+                break;
+            case Role::Player:
+                if ((events & EPOLLOUT) != 0U) {
+                    connection.player->onWritable();
+                }
+                if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0U) {
+                    connection.player->onReadable();
+                }
+                updateSessionEvents(connection.session);
+                reapSpectators(connection.session);
+                break;
+            case Role::Spectator: {
+                const auto session_index = connection.session;
+                if ((events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0U && !drainInput(connection.fd)) {
+                    detachSpectator(index);
+                    break;
+                }
+                if ((events & EPOLLOUT) != 0U) {
+                    sessions_[session_index].spectators->onWritable(index);
+                }
+                reapSpectators(session_index);
+                break;
+            }
+        }
+    }
+
+    // Reads and ignores everything available, false once the peer is gone
+    static bool drainInput(int socket_fd) {
+        std::array<uint8_t, 64> discard;
+        while (true) {
+            const auto received = recv(socket_fd, discard.data(), discard.size(), 0);
+            if (received > 0 || (received < 0 && errno == EINTR)) {
+                continue;
+            }
+            return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+
+    void readFirstFrame(uint32_t index) {
+        auto &connection = connections_[index];
+        const auto received = recv(connection.fd, connection.input.data() + connection.input_size,
+                                   connection.input.size() - connection.input_size, 0);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+        if (received <= 0) {
+            closeConnection(index);
+            return;
+        }
+        connection.input_size += static_cast<size_t>(received);
+        const auto parsed = Wire::parseFrame(std::span<const uint8_t>(connection.input.data(), connection.input_size));
+        if (parsed.status == Wire::ParseStatus::kIncomplete) {
+            return;
+        }
+        if (parsed.status == Wire::ParseStatus::kFrame && parsed.frame.type == Wire::MessageType::Join) {
+            connection.role = Role::Waiting;
+            if (waiting_connection_.has_value()) {
+                startSession(*std::exchange(waiting_connection_, std::nullopt), index);
+            } else {
+                waiting_connection_ = index;
+            }
+        } else if (parsed.status == Wire::ParseStatus::kFrame && parsed.frame.type == Wire::MessageType::Watch) {
+            routeSpectator(index, Wire::WatchMessage{parsed.frame.payload}.session());
+        } else {
+            LOG_W("Unexpected first frame from a client, closing it");
+            closeConnection(index);
+        }
+    }
+
+    void routeSpectator(uint32_t index, uint32_t session) {
+        const auto shard_index = session >> kSessionIndexBits;
+        const auto session_index = session & kSessionIndexMask;
+        if (shard_index == shard_index_) {
+            attachSpectator(index, session_index);
+            return;
+        }
+        const int socket_fd = connections_[index].fd;
+        releaseConnection(index);
+        if (shard_index >= peers_.size() || !peers_[shard_index]->adoptSpectator(socket_fd, session_index)) {
+            LOG_W("Cannot hand spectator over to shard {}", shard_index);
+            close(socket_fd);
+        }
+    }
+
+    void attachSpectator(uint32_t index, uint32_t session_index) {
+        if (!sessions_.contains(session_index) || sessions_[session_index].closing) {
+            LOG_D("Spectator asked for unknown session {}", session_index);
+            closeConnection(index);
+            return;
+        }
+        auto &connection = connections_[index];
+        auto &session = sessions_[session_index];
+        connection.role = Role::Spectator;
+        connection.session = session_index;
+        epoll_event event {.events = kSpectatorEvents, .data = {.u64 = index}};
+        epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.registered_events = kSpectatorEvents;
+        session.spectator_connections.push_back(index);
+        session.spectators->subscribe(index, connection.fd);
+        spectators_attached_.fetch_add(1U, std::memory_order_relaxed);
+        reapSpectators(session_index);
+    }
+
+    void detachSpectator(uint32_t index) {
+        const auto session_index = connections_[index].session;
+        auto &session = sessions_[session_index];
+        session.spectators->unsubscribe(index);
+        std::erase(session.spectator_connections, index);
+        closeConnection(index);
+    }
+
+    // Closes the spectators the hub gave up on
+    void reapSpectators(uint32_t session_index) {
+        if (session_index == kNoSession || !sessions_.contains(session_index)) {
+            return;
+        }
+        auto &session = sessions_[session_index];
+        if (session.spectators == nullptr) {
+            return;
+        }
+        for (const auto subscriber : session.spectators->takeDropped()) {
+            const auto index = static_cast<uint32_t>(subscriber);
+            std::erase(session.spectator_connections, index);
+            closeConnection(index);
+        }
+    }
+
+    void startSession(uint32_t host_index, uint32_t guest_index) {
+        const auto session_index = *sessions_.allocate(host_index, guest_index);
+        auto &session = sessions_[session_index];
+        auto &host = connections_[host_index];
+        auto &guest = connections_[guest_index];
+        try {
+            const auto session_id = (shard_index_ << kSessionIndexBits) | session_index;
+            host.player.emplace(BoardPlayerType::X, host.fd, move_timeout_, session_id);
+            guest.player.emplace(BoardPlayerType::O, guest.fd, move_timeout_, session_id);
+            host.role = Role::Player;
+            guest.role = Role::Player;
+            host.session = session_index;
+            guest.session = session_index;
+            const auto on_disconnect = [this, session_index]() {
+                onPlayerDisconnected(session_index);
+            };
+            host.player->setDisconnectCallback(on_disconnect);
+            guest.player->setDisconnectCallback(on_disconnect);
+
+            // Players live in the slab, the session only borrows them
+            auto player_manager = std::make_shared<PlayerManager::PlayerManager>(
+                    PlayerManager::TypeOfGuestPlayer::Remote,
+                    std::shared_ptr<Player::IPlayer>(std::shared_ptr<Player::IPlayer>(), &*host.player),
+                    std::shared_ptr<Player::IPlayer>(std::shared_ptr<Player::IPlayer>(), &*guest.player));
+            session.game_manager = std::make_unique<GameManager::GameManager>(std::move(player_manager));
+            session.spectators = std::make_shared<Spectator::SpectatorHub>();
+            session.game_manager->addEventListener(session.spectators);
+            if (journal_ != nullptr) {
+                session.game_manager->addEventListener(std::make_shared<Journal::SessionJournal>(
+                    journal_, session_id, session.game_manager->snapshot()));
+            }
+        } catch (const std::exception &e) {
+            LOG_E("Failed to start session: {}", e.what());
+            session.finished = true;
+            session.closing = true;
+            closing_.push_back(session_index);
+            return;
+        }
+        sessions_started_.fetch_add(1U, std::memory_order_relaxed);
+        LOG_D("Session {} started", session_index);
+        Coro::spawn(session.game_manager->playAsync(), [this, session_index](std::exception_ptr failure) {
+            if (failure) {
+                try {
+                    std::rethrow_exception(failure);
+                } catch (const std::exception &e) {
+                    LOG_E("Session {} failed: {}", session_index, e.what());
+                }
+            }
+            auto &finished_session = sessions_[session_index];
+            finished_session.finished = true;
+            queueClose(session_index);
+        });
+        updateSessionEvents(session_index);
+    }
+
+    // Runs before the disconnected player answers its pending move, so the game loop sees the stop
+    void onPlayerDisconnected(uint32_t session_index) {
+        auto &session = sessions_[session_index];
+        if (session.game_manager != nullptr) {
+            session.game_manager->stopGame();
+        }
+        queueClose(session_index);
+    }
+
+    void queueClose(uint32_t session_index) {
+        auto &session = sessions_[session_index];
+        if (!session.closing) {
+            session.closing = true;
+            closing_.push_back(session_index);
+        }
+    }
+
+    void checkTimeouts(std::chrono::steady_clock::time_point now) {
+        connections_.forEach([now](uint32_t, Connection &connection) {
+            if (connection.player.has_value()) {
+                connection.player->onTimeout(now);
+            }
+        });
+    }
+
+    void updateSessionEvents(uint32_t session_index) {
+        if (session_index == kNoSession || !sessions_.contains(session_index)) {
+            return;
+        }
+        const auto &session = sessions_[session_index];
+        updateEvents(session.host);
+        updateEvents(session.guest);
+    }
+
+    void updateEvents(uint32_t index) {
+        auto &connection = connections_[index];
+        if (!connection.player.has_value() || !connection.player->is_connected()) {
+            return;
+        }
+        const auto events = connection.player->wants_write() ? (kReadEvents | EPOLLOUT) : kReadEvents;
+        if (events != connection.registered_events) {
+            epoll_event event {.events = events, .data = {.u64 = index}};
+            epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &event);
+            connection.registered_events = events;
+        }
+    }
+
+    // Sessions are torn down here, outside of any player or coroutine call stack
+    void closeSessions() {
+        if (closing_.empty()) {
+            return;
+        }
+        auto pending = std::exchange(closing_, {});
+        for (const auto session_index : pending) {
+            auto &session = sessions_[session_index];
+            if (!session.finished) {
+                // Resumes the loop suspended on a move, playAsync() sees the stop and returns
+                session.game_manager->stopGame();
+            }
+            if (!session.finished) {
+                closing_.push_back(session_index);
+                continue;
+            }
+            session.game_manager.reset();
+            session.spectators.reset();
+            for (const auto index : session.spectator_connections) {
+                closeConnection(index);
+            }
+            closeConnection(session.host);
+            closeConnection(session.guest);
+            sessions_.release(session_index);
+            sessions_finished_.fetch_add(1U, std::memory_order_relaxed);
+            LOG_D("Session {} closed", session_index);
+        }
+        pending.clear();
+        if (closing_.empty()) {
+            closing_ = std::move(pending);
+        }
+    }
+
+    void closeConnection(uint32_t index) {
+        auto &connection = connections_[index];
+        if (connection.player.has_value()) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+            connection.player.reset();
+            connections_.release(index);
+            active_connections_.fetch_sub(1U, std::memory_order_relaxed);
+            return;
+        }
+        const int socket_fd = connection.fd;
+        releaseConnection(index);
+        close(socket_fd);
+    }
+
+    // Forgets the connection but leaves its socket open
+    void releaseConnection(uint32_t index) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, connections_[index].fd, nullptr);
+        connections_.release(index);
+        active_connections_.fetch_sub(1U, std::memory_order_relaxed);
+    }
+
+    void shutdown() {
+        sessions_.forEach([this](uint32_t session_index, Session &) {
+            onPlayerDisconnected(session_index);
+        });
+        closeSessions();
+        waiting_connection_.reset();
+        connections_.forEach([this](uint32_t index, Connection &) {
+            closeConnection(index);
+        });
+        while (const auto handoff = handoffs_.tryPop()) {
+            close(handoff->fd);
+        }
+    }
+};
+
+class GameServerImpl : public IGameServer {
+public:
+    explicit GameServerImpl(GameServerConfig config) {
+        if (config.shards == 0U || config.shards > (1U << (32U - kSessionIndexBits)) ||
+            config.max_connections_per_shard < 2U || config.max_connections_per_shard > kSessionIndexMask) {
+            LOG_E("Invalid game server shard or connection count");
+            throw std::runtime_error("Invalid game server shard or connection count");
+        }
+        if (!config.journal_path.empty()) {
+            const auto recovered = Journal::recoverJournal(config.journal_path);
+            if (!recovered.sessions.empty()) {
+                LOG_W("{} sessions were interrupted, their remote players cannot be resumed",
+                      recovered.sessions.size());
+            }
+            journal_ = std::make_shared<Journal::JournalWriter>(config.journal_path,
+                                                                Journal::JournalConfig{.truncate = true});
+        }
+        port_ = config.port;
+        for (size_t i = 0; i < config.shards; ++i) {
+            const int listen_fd = Remote::listenTcp(config.address, port_, SOMAXCONN, true);
+            // With port 0 the first listener picks the port, the others join it
+            port_ = Remote::localPort(listen_fd);
+            shards_.push_back(std::make_unique<Shard>(config, static_cast<uint32_t>(i), listen_fd, journal_));
+        }
+        std::vector<Shard *> peers;
+        for (auto &shard : shards_) {
+            peers.push_back(shard.get());
+        }
+        for (auto &shard : shards_) {
+            shard->setPeers(peers);
+        }
+        LOG_I("Game server listening on {}:{} with {} shards", config.address, port_, config.shards);
+    }
+
+    ~GameServerImpl() override {
+        stop();
+    }
+
+    void start() override {
+        for (auto &shard : shards_) {
+            shard->start();
+        }
+    }
+
+    void stop() override {
+        for (auto &shard : shards_) {
+            shard->stop();
+        }
+    }
+
+    uint16_t port() const override {
+        return port_;
+    }
+
+    GameServerStats stats() const override {
+        GameServerStats stats;
+        for (const auto &shard : shards_) {
+            shard->addStats(stats);
+        }
+        if (journal_ != nullptr) {
+            const auto journal_stats = journal_->stats();
+            stats.journal_records = journal_stats.records;
+            stats.journal_commits = journal_stats.commits;
+            stats.journal_failed = journal_stats.failed;
+            stats.journal_dropped = journal_stats.dropped;
+        }
+        return stats;
+    }
+
+private:
+    uint16_t port_ = 0;
+    std::shared_ptr<Journal::JournalWriter> journal_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+GameServer::GameServer(GameServerConfig config) :
+    impl_(std::make_unique<GameServerImpl>(std::move(config))) {
+}
+
+} // namespace GameServer
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "game_engine.h"
+
+namespace Journal {
+
+// File layout, all integers little-endian:
+//   file header: "TTTJ" magic, version byte, 3 reserved bytes
+//   records:     u32 CRC-32 of the rest of the record, type u8, payload size u8, session u32, payload
+// Payloads:
+//   Open      engine snapshot the session starts from
+//   Move      row u8, col u8, player type u8, move number u8
+//   RoundEnd  result u8, reserved u8[3], host score u32, guest score u32, round u32
+//   Reset     flags u8 (kResetHostTurn, kResetHostStartedRound)
+//   Close     empty, the session ended normally and needs no recovery
+constexpr std::array<char, 4> kFileMagic = {'T', 'T', 'T', 'J'};
+constexpr uint8_t kFormatVersion = 1U;
+constexpr size_t kFileHeaderSize = 8U;
+constexpr size_t kRecordHeaderSize = 10U;
+
+constexpr uint8_t kResetHostTurn = 0x01U;
+constexpr uint8_t kResetHostStartedRound = 0x02U;
+
+enum class RecordType : uint8_t {
+    Open = 1,
+    Move = 2,
+    RoundEnd = 3,
+    Reset = 4,
+    Close = 5
+};
+
+// Position in the journal, bytes appended since the writer was opened
+using Lsn = uint64_t;
+// Returned by append() once the journal failed, never becomes durable
+constexpr Lsn kFailedLsn = UINT64_MAX;
+
+struct JournalConfig {
+    // Appends are collected this long and then made durable with a single fdatasync
+    std::chrono::microseconds commit_interval{2000};
+    // A batch this large is committed without waiting for the interval
+    size_t max_batch_bytes = 1024U * 1024U;
+    // Start an empty journal instead of appending to the existing one
+    bool truncate = false;
+};
+
+struct JournalStats {
+    size_t records = 0;
+    size_t commits = 0;     // fdatasync calls, each one covers every record of its batch
+    size_t bytes = 0;
+    bool failed = false;    // a write or fdatasync failed, nothing is written anymore
+    size_t dropped = 0;     // records lost by the failure or appended after it
+};
+
+class IJournalWriter {
+public:
+    virtual ~IJournalWriter() = default;
+    // Thread safe, never blocks on the disk. Returns the position to wait for with waitDurable(),
+    // kFailedLsn without keeping the record once the journal failed.
+    virtual Lsn append(RecordType type, uint32_t session, std::span<const uint8_t> payload) = 0;
+    // Blocks until everything up to lsn is on disk, false if the journal failed
+    virtual bool waitDurable(Lsn lsn) = 0;
+    virtual JournalStats stats() const = 0;
+};
+
+class JournalWriterImpl;
+
+// Append-only write-ahead journal shared by many sessions. A background thread group commits:
+// the records appended by all sessions during one commit interval are written together and
+// made durable by a single fdatasync. A torn record left by a crash is cut off on open.
+class JournalWriter : public IJournalWriter {
+public:
+    // Throws std::runtime_error when the file cannot be opened
+    explicit JournalWriter(const std::string &path, JournalConfig config = {});
+    ~JournalWriter() override;
+
+    Lsn append(RecordType type, uint32_t session, std::span<const uint8_t> payload) override;
+    bool waitDurable(Lsn lsn) override;
+    JournalStats stats() const override;
+
+    // Waits for everything appended so far
+    bool sync();
+
+private:
+    std::unique_ptr<JournalWriterImpl> impl_;
+};
+
+// Journals one session's engine events. Opening writes the starting snapshot, destroying it
+// records a normal end of the session.
+class SessionJournal : public GameEngine::IGameEventListener {
+public:
+    SessionJournal(std::shared_ptr<IJournalWriter> writer, uint32_t session, const GameEngine::Snapshot &snapshot);
+    ~SessionJournal() override;
+
+    void onMove(std::pair<int, int> move, BoardPlayerType player_type, size_t move_number) override;
+    void onRoundEnd(RoundResult result, std::pair<int, int> score, size_t round) override;
+    void onReset(bool host_turn, bool host_started_round) override;
+
+private:
+    std::shared_ptr<IJournalWriter> writer_;
+    uint32_t session_;
+};
+
+struct RecoveredSession {
+    uint32_t session;
+    GameEngine::Snapshot snapshot;
+};
+
+struct RecoveryResult {
+    std::vector<RecoveredSession> sessions;    // sessions without a Close record, by session id
+    size_t records = 0;
+    bool torn_tail = false;     // the last record was incomplete or failed its checksum
+};
+
+// Replays the journal and rebuilds the engine state of every session which did not end
+// normally, restore it with GameEngine::restore() or GameManager's snapshot constructor.
+// A missing file gives an empty result, an invalid header throws std::runtime_error.
+RecoveryResult recoverJournal(const std::string &path);
+
+} // namespace Journal
@@ -0,0 +1,457 @@
+#include "journal.h"
+#include "log.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Journal {
+
+namespace {
+
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table {};
+    for (uint32_t index = 0; index < table.size(); ++index) {
+        uint32_t value = index;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1U) != 0U ? (value >> 1U) ^ 0xEDB88320U : value >> 1U;
+        }
+        table[index] = value;
+    }
+    return table;
+}
+
+constexpr auto kCrcTable = makeCrcTable();
+
+// CRC-32 (IEEE), catches records torn by a crash in the middle of a write
+uint32_t crc32(std::span<const uint8_t> data) {
+    uint32_t crc = 0xFFFFFFFFU;
+    for (const auto byte : data) {
+        crc = kCrcTable[(crc ^ byte) & 0xFFU] ^ (crc >> 8U);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+void storeU32(uint8_t *out, uint32_t value) {
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8U * i));
+    }
+}
+
+uint32_t loadU32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < sizeof(value); ++i) {
+        value |= static_cast<uint32_t>(in[i]) << (8U * i);
+    }
+    return value;
+}
+
+// The payload size is stored in one byte of the record header
+static_assert(GameEngine::kSnapshotSize <= UINT8_MAX, "Open payload does not fit the record header");
+
+size_t payloadSize(RecordType type) {
+    switch (type) {
+        case RecordType::Open:
+            return GameEngine::kSnapshotSize;
+        case RecordType::Move:
+            return 4U;
+        case RecordType::RoundEnd:
+            return 16U;
+        case RecordType::Reset:
+            return 1U;
+        case RecordType::Close:
+            return 0U;
+    }
+    return SIZE_MAX;
+}
+
+struct RecordView {
+    RecordType type;
+    uint32_t session;
+    std::span<const uint8_t> payload;
+};
+
+std::vector<uint8_t> readFile(int fd) {
+    std::vector<uint8_t> data;
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0) {
+        return data;
+    }
+    data.resize(static_cast<size_t>(file_stat.st_size));
+    size_t offset = 0;
+    while (offset < data.size()) {
+        const auto result = ::pread(fd, data.data() + offset, data.size() - offset, static_cast<off_t>(offset));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            break;
+        }
+        offset += static_cast<size_t>(result);
+    }
+    data.resize(offset);
+    return data;
+}
+
+bool isValidHeader(std::span<const uint8_t> data) {
+    return data.size() >= kFileHeaderSize && std::equal(kFileMagic.begin(), kFileMagic.end(), data.begin()) &&
+           data[kFileMagic.size()] == kFormatVersion;
+}
+
+// Calls f for every intact record, returns the end of the last one
+template <typename Function>
+size_t scanRecords(std::span<const uint8_t> data, Function &&f) {
+    size_t offset = kFileHeaderSize;
+    while (data.size() - offset >= kRecordHeaderSize) {
+        const auto *record = data.data() + offset;
+        const auto type = static_cast<RecordType>(record[4]);
+        const size_t size = record[5];
+        if (size != payloadSize(type) || data.size() - offset - kRecordHeaderSize < size ||
+            crc32(data.subspan(offset + 4U, kRecordHeaderSize - 4U + size)) != loadU32(record)) {
+            break;
+        }
+        f(RecordView{type, loadU32(record + 6), data.subspan(offset + kRecordHeaderSize, size)});
+        offset += kRecordHeaderSize + size;
+    }
+    return offset;
+}
+
+// Applies one event the way GameEngineImpl does
+void replay(GameEngine::EngineState &state, const RecordView &record) {
+    const auto *payload = record.payload.data();
+    switch (record.type) {
+        case RecordType::Move: {
+            const auto row = payload[0];
+            const auto col = payload[1];
+            const auto player_type = static_cast<BoardPlayerType>(payload[2]);
+            const auto field = Board::convertPlayerTypeToBoardField(player_type);
+            if (row >= Board::kBoardSize || col >= Board::kBoardSize || field == Board::BoardField::EMPTY ||
+                state.board[row][col] != Board::BoardField::EMPTY || state.game_finished ||
+                state.round_move_count >= state.round_moves.size()) {
+                LOG_W("Invalid move in journal for session {}", record.session);
+                return;
+            }
+            state.board[row][col] = field;
+            state.round_moves[state.round_move_count++] = static_cast<uint16_t>(row * Board::kBoardSize + col);
+            // The RoundEnd record is appended after the move and can be lost with the batch after
+            // it, so the round is closed here. A RoundEnd that made it sets the same values again.
+            if (Board::isPlayerWinner(state.board, player_type)) {
+                ++(state.host_turn ? state.host_score : state.guest_score);
+                ++state.rounds_played;
+                state.game_finished = true;
+            } else if (Board::isBoardFull(state.board)) {
+                ++state.rounds_played;
+                state.game_finished = true;
+            }
+            state.host_turn = !state.host_turn;
+            break;
+        }
+        case RecordType::RoundEnd:
+            state.host_score = loadU32(payload + 4);
+            state.guest_score = loadU32(payload + 8);
+            state.rounds_played = loadU32(payload + 12);
+            state.game_finished = true;
+            break;
+        case RecordType::Reset:
+            state.board = {};
+            state.round_move_count = 0;
+            state.game_finished = false;
+            state.host_turn = (payload[0] & kResetHostTurn) != 0U;
+            state.host_started_round = (payload[0] & kResetHostStartedRound) != 0U;
+            break;
+        case RecordType::Open:
+        case RecordType::Close:
+            break;
+    }
+}
+
+} // namespace
+
+class JournalWriterImpl : public IJournalWriter {
+public:
+    JournalWriterImpl(const std::string &path, JournalConfig config) : config_(config) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            LOG_E("Cannot open journal {}: {}", path, std::strerror(errno));
+            throw std::runtime_error("Cannot open journal");
+        }
+        size_t valid_size = 0;
+        if (!config_.truncate) {
+            const auto data = readFile(fd_);
+            if (!data.empty() && !isValidHeader(data)) {
+                ::close(fd_);
+                LOG_E("Invalid journal header in {}", path);
+                throw std::runtime_error("Invalid journal header");
+            }
+            if (!data.empty()) {
+                valid_size = scanRecords(data, [](const RecordView &) {});
+                if (valid_size < data.size()) {
+                    LOG_W("Cutting {} bytes of torn journal tail", data.size() - valid_size);
+                }
+            }
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(valid_size)) != 0 ||
+            ::lseek(fd_, static_cast<off_t>(valid_size), SEEK_SET) < 0) {
+            ::close(fd_);
+            LOG_E("Cannot truncate journal {}: {}", path, std::strerror(errno));
+            throw std::runtime_error("Cannot truncate journal");
+        }
+        if (valid_size == 0U) {
+            pending_.insert(pending_.end(), kFileMagic.begin(), kFileMagic.end());
+            pending_.push_back(kFormatVersion);
+            pending_.resize(kFileHeaderSize, 0U);
+            appended_ = pending_.size();
+        }
+        commit_thread_ = std::thread(&JournalWriterImpl::commitLoop, this);
+        LOG_D("Journal opened {}", path);
+    }
+
+    ~JournalWriterImpl() override {
+        {
+            std::scoped_lock lock(mutex_);
+            stopping_ = true;
+        }
+        commit_cv_.notify_one();
+        commit_thread_.join();
+        ::close(fd_);
+    }
+
+    Lsn append(RecordType type, uint32_t session, std::span<const uint8_t> payload) override {
+        std::array<uint8_t, kRecordHeaderSize> header {};
+        header[4] = static_cast<uint8_t>(type);
+        header[5] = static_cast<uint8_t>(payload.size());
+        storeU32(header.data() + 6, session);
+
+        std::unique_lock lock(mutex_);
+        // Nothing can be written anymore, keeping the records would only grow memory
+        if (stats_.failed) {
+            ++stats_.dropped;
+            return kFailedLsn;
+        }
+        const auto start = pending_.size();
+        pending_.insert(pending_.end(), header.begin(), header.end());
+        pending_.insert(pending_.end(), payload.begin(), payload.end());
+        storeU32(pending_.data() + start, crc32(std::span<const uint8_t>(pending_).subspan(start + 4U)));
+        appended_ += kRecordHeaderSize + payload.size();
+        ++pending_records_;
+        ++stats_.records;
+        const auto lsn = appended_;
+        const bool full = pending_.size() >= config_.max_batch_bytes;
+        lock.unlock();
+        if (full) {
+            commit_cv_.notify_one();
+        }
+        return lsn;
+    }
+
+    bool waitDurable(Lsn lsn) override {
+        std::unique_lock lock(mutex_);
+        if (durable_ >= lsn) {
+            return true;
+        }
+        // Somebody waits, no point in sleeping out the rest of the interval
+        sync_requested_ = true;
+        commit_cv_.notify_one();
+        durable_cv_.wait(lock, [this, lsn]() {
+            return durable_ >= lsn || stats_.failed;
+        });
+        return durable_ >= lsn;
+    }
+
+    JournalStats stats() const override {
+        std::scoped_lock lock(mutex_);
+        return stats_;
+    }
+
+    Lsn appended() const {
+        std::scoped_lock lock(mutex_);
+        return appended_;
+    }
+
+private:
+    JournalConfig config_;
+    int fd_ = -1;
+    std::thread commit_thread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable commit_cv_;
+    std::condition_variable durable_cv_;
+    std::vector<uint8_t> pending_;
+    size_t pending_records_ = 0;
+    Lsn appended_ = 0;
+    Lsn durable_ = 0;
+    bool sync_requested_ = false;
+    bool stopping_ = false;
+    JournalStats stats_;
+
+    void commitLoop() {
+        std::vector<uint8_t> batch;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            commit_cv_.wait_for(lock, config_.commit_interval, [this]() {
+                return stopping_ || sync_requested_ || pending_.size() >= config_.max_batch_bytes;
+            });
+            if (pending_.empty()) {
+                sync_requested_ = false;
+                if (stopping_) {
+                    break;
+                }
+                continue;
+            }
+            batch.swap(pending_);
+            const auto batch_records = std::exchange(pending_records_, 0U);
+            const auto batch_end = appended_;
+            sync_requested_ = false;
+            lock.unlock();
+
+            const bool written = writeAll(batch) && ::fdatasync(fd_) == 0;
+            if (!written) {
+                const auto error = errno;
+                LOG_E("Journal commit failed, dropping further records: {}", std::strerror(error));
+            }
+            const auto batch_size = batch.size();
+            batch.clear();
+
+            lock.lock();
+            if (written) {
+                durable_ = batch_end;
+                ++stats_.commits;
+                stats_.bytes += batch_size;
+            } else {
+                // The batch and everything appended meanwhile is lost, later appends are dropped
+                stats_.failed = true;
+                stats_.dropped += batch_records + std::exchange(pending_records_, 0U);
+                pending_ = {};
+                batch = {};
+            }
+            durable_cv_.notify_all();
+        }
+    }
+
+    bool writeAll(const std::vector<uint8_t> &data) {
+        size_t written = 0;
+        while (written < data.size()) {
+            const auto result = ::write(fd_, data.data() + written, data.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            written += static_cast<size_t>(result);
+        }
+        return true;
+    }
+};
+
+JournalWriter::JournalWriter(const std::string &path, JournalConfig config) :
+    impl_(std::make_unique<JournalWriterImpl>(path, config)) {
+}
+
+JournalWriter::~JournalWriter() = default;
+
+Lsn JournalWriter::append(RecordType type, uint32_t session, std::span<const uint8_t> payload) {
+    return impl_->append(type, session, payload);
+}
+
+bool JournalWriter::waitDurable(Lsn lsn) {
+    return impl_->waitDurable(lsn);
+}
+
+JournalStats JournalWriter::stats() const {
+    return impl_->stats();
+}
+
+bool JournalWriter::sync() {
+    return impl_->waitDurable(impl_->appended());
+}
+
+SessionJournal::SessionJournal(std::shared_ptr<IJournalWriter> writer, uint32_t session,
+                               const GameEngine::Snapshot &snapshot) :
+        writer_(std::move(writer)), session_(session) {
+    writer_->append(RecordType::Open, session_, snapshot);
+}
+
+SessionJournal::~SessionJournal() {
+    writer_->append(RecordType::Close, session_, {});
+}
+
+void SessionJournal::onMove(std::pair<int, int> move, BoardPlayerType player_type, size_t move_number) {
+    const std::array<uint8_t, 4> payload = {static_cast<uint8_t>(move.first), static_cast<uint8_t>(move.second),
+                                            static_cast<uint8_t>(player_type), static_cast<uint8_t>(move_number)};
+    writer_->append(RecordType::Move, session_, payload);
+}
+
+void SessionJournal::onRoundEnd(RoundResult result, std::pair<int, int> score, size_t round) {
+    std::array<uint8_t, 16> payload {};
+    payload[0] = static_cast<uint8_t>(result);
+    storeU32(payload.data() + 4, static_cast<uint32_t>(score.first));
+    storeU32(payload.data() + 8, static_cast<uint32_t>(score.second));
+    storeU32(payload.data() + 12, static_cast<uint32_t>(round));
+    writer_->append(RecordType::RoundEnd, session_, payload);
+}
+
+void SessionJournal::onReset(bool host_turn, bool host_started_round) {
+    const std::array<uint8_t, 1> payload = {
+        static_cast<uint8_t>((host_turn ? kResetHostTurn : 0U) | (host_started_round ? kResetHostStartedRound : 0U))};
+    writer_->append(RecordType::Reset, session_, payload);
+}
+
+RecoveryResult recoverJournal(const std::string &path) {
+    RecoveryResult result;
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return result;
+        }
+        LOG_E("Cannot open journal {}: {}", path, std::strerror(errno));
+        throw std::runtime_error("Cannot open journal");
+    }
+    const auto data = readFile(fd);
+    ::close(fd);
+    if (data.empty()) {
+        return result;
+    }
+    if (!isValidHeader(data)) {
+        LOG_E("Invalid journal header in {}", path);
+        throw std::runtime_error("Invalid journal header");
+    }
+
+    std::map<uint32_t, GameEngine::EngineState> sessions;
+    const auto valid_size = scanRecords(data, [&](const RecordView &record) {
+        ++result.records;
+        if (record.type == RecordType::Open) {
+            GameEngine::Snapshot snapshot {};
+            if (record.payload.size() != snapshot.size()) {
+                return;
+            }
+            std::copy_n(record.payload.data(), snapshot.size(), snapshot.begin());
+            if (auto state = GameEngine::decodeSnapshot(snapshot)) {
+                sessions[record.session] = *state;
+            }
+        } else if (record.type == RecordType::Close) {
+            sessions.erase(record.session);
+        } else if (const auto it = sessions.find(record.session); it != sessions.end()) {
+            replay(it->second, record);
+        }
+    });
+    result.torn_tail = valid_size < data.size();
+
+    result.sessions.reserve(sessions.size());
+    for (const auto &[session, state] : sessions) {
+        result.sessions.push_back(RecoveredSession{session, GameEngine::encodeSnapshot(state)});
+    }
+    LOG_I("Journal {} replayed: {} records, {} sessions to recover", path, result.records, result.sessions.size());
+    return result;
+}
+
+} // namespace Journal
@@ -1,8 +1,90 @@
 #include "log.h"
 
-void init_logger() {
-    // spdlog::set_level(spdlog::level::trace);
-    spdlog::set_level(spdlog::level::err); // Set global log level to error
-    spdlog::set_pattern("[%H:%M:%S.%e][%L][tid: %t]%s:%# %v");
-    spdlog::info("Logger initialized");
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace {
+
+constexpr std::array<const char *, Log::kModuleCount> kModuleNames = {"app", "board", "bot", "engine", "ui", "net"};
+
+// Slots preallocated by the async queue, each holds one unformatted message
+constexpr size_t kAsyncQueueSize = 8192U;
+
+// Loggers are owned by the spdlog registry, which outlives every call site
+std::array<std::shared_ptr<spdlog::logger>, Log::kModuleCount> g_loggers;
+
+} // namespace
+
+namespace Log {
+
+void setLevel(Module module, spdlog::level::level_enum level) {
+    logger(module)->set_level(level);
+}
+
+void setLevels(std::string_view spec) {
+    while (!spec.empty()) {
+        const auto separator = spec.find(',');
+        const auto entry = spec.substr(0, separator);
+        spec = separator == std::string_view::npos ? std::string_view {} : spec.substr(separator + 1U);
+
+        const auto equals = entry.find('=');
+        const auto value = equals == std::string_view::npos ? entry : entry.substr(equals + 1U);
+        const auto level = spdlog::level::from_str(std::string(value));
+        // from_str() answers off for anything unknown
+        if (level == spdlog::level::off && value != "off") {
+            continue;
+        }
+        if (equals == std::string_view::npos) {
+            for (size_t module = 0; module < kModuleCount; ++module) {
+                setLevel(static_cast<Module>(module), level);
+            }
+            continue;
+        }
+        const auto name = entry.substr(0, equals);
+        for (size_t module = 0; module < kModuleCount; ++module) {
+            if (name == kModuleNames[module]) {
+                setLevel(static_cast<Module>(module), level);
+            }
+        }
+    }
+}
+
+} // namespace Log
+
+void init_logger(Log::Mode mode) {
+    if (g_loggers.front() != nullptr) {
+        return;
+    }
+    // One sink shared by all modules, so their lines do not interleave
+    auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    if (mode == Log::Mode::Async) {
+        spdlog::init_thread_pool(kAsyncQueueSize, 1U);
+    }
+    for (size_t module = 0; module < Log::kModuleCount; ++module) {
+        std::shared_ptr<spdlog::logger> module_logger;
+        if (mode == Log::Mode::Async) {
+            // The game threads never wait for the writer, on overflow the oldest message is lost
+            module_logger = std::make_shared<spdlog::async_logger>(kModuleNames[module], sink, spdlog::thread_pool(),
+                                                                   spdlog::async_overflow_policy::overrun_oldest);
+        } else {
+            module_logger = std::make_shared<spdlog::logger>(kModuleNames[module], sink);
+        }
+        module_logger->set_pattern("[%H:%M:%S.%e][%L][%n][tid: %t]%s:%# %v");
+        module_logger->set_level(spdlog::level::err);
+        module_logger->flush_on(spdlog::level::err);
+        spdlog::register_logger(module_logger);
+        g_loggers[module] = module_logger;
+    }
+    spdlog::set_default_logger(g_loggers.front());
+    for (size_t module = 0; module < Log::kModuleCount; ++module) {
+        Log::detail::g_module_loggers[module] = g_loggers[module].get();
+    }
+    if (const char *spec = std::getenv("TICTACTOE_LOG_LEVEL")) {
+        Log::setLevels(spec);
+    }
+    LOG_I("Logger initialized");
 }
@@ -2,14 +2,100 @@
 
 #include <spdlog/spdlog.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
 
-// Logging macros
-#define LOG_V(...) SPDLOG_LOGGER_TRACE(spdlog::default_logger_raw(), __VA_ARGS__)
-#define LOG_D(...) SPDLOG_LOGGER_DEBUG(spdlog::default_logger_raw(), __VA_ARGS__)
-#define LOG_I(...) SPDLOG_LOGGER_INFO(spdlog::default_logger_raw(), __VA_ARGS__)
-#define LOG_W(...) SPDLOG_LOGGER_WARN(spdlog::default_logger_raw(), __VA_ARGS__)
-#define LOG_E(...) SPDLOG_LOGGER_ERROR(spdlog::default_logger_raw(), __VA_ARGS__)
-#define LOG_F(...) SPDLOG_LOGGER_CRITICAL(spdlog::default_logger_raw(), __VA_ARGS__)
+namespace Log {
 
-// Initialize logger
-void init_logger();
+// Subsystems with their own logger and level. A library picks its module with the compile
+// definition LOG_MODULE=<name> in its CMakeLists.txt, everything else logs as App.
+enum class Module : uint8_t {
+    App,
+    Board,
+    Bot,
+    Engine,
+    UI,
+    Net,
+    Count
+};
+
+constexpr size_t kModuleCount = static_cast<size_t>(Module::Count);
+
+enum class Mode {
+    Async,  // formatted and written by a background thread, a full queue drops the oldest messages
+    Sync    // written by the calling thread
+};
+
+namespace detail {
+// Filled by init_logger(), empty entries use the default logger
+inline std::array<spdlog::logger *, kModuleCount> g_module_loggers {};
+} // namespace detail
+
+inline spdlog::logger *logger(Module module) noexcept {
+    auto *module_logger = detail::g_module_loggers[static_cast<size_t>(module)];
+    return module_logger != nullptr ? module_logger : spdlog::default_logger_raw();
+}
+
+void setLevel(Module module, spdlog::level::level_enum level);
+// Comma separated levels, a bare level applies to all modules: "err,bot=debug,engine=trace".
+// Unknown modules and levels are ignored.
+void setLevels(std::string_view spec);
+
+} // namespace Log
+
+#ifndef LOG_MODULE
+#define LOG_MODULE App
+#endif
+
+// True when a message of the level (trace, debug, info, warn, err, critical) would be written,
+// guards building expensive log arguments. Constant false below the compile time floor.
+#define LOG_ENABLED(severity) \
+    (SPDLOG_ACTIVE_LEVEL <= spdlog::level::severity && \
+     Log::logger(Log::Module::LOG_MODULE)->should_log(spdlog::level::severity))
+
+// The arguments are only evaluated when the message is written
+#define LOG_AT(severity, ...) \
+    do { \
+        if (LOG_ENABLED(severity)) { \
+            Log::logger(Log::Module::LOG_MODULE)->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, \
+                                                       spdlog::level::severity, __VA_ARGS__); \
+        } \
+    } while (false)
+
+// Logging macros, levels below SPDLOG_ACTIVE_LEVEL are compiled out
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define LOG_V(...) LOG_AT(trace, __VA_ARGS__)
+#else
+#define LOG_V(...) (void)0
+#endif
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define LOG_D(...) LOG_AT(debug, __VA_ARGS__)
+#else
+#define LOG_D(...) (void)0
+#endif
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define LOG_I(...) LOG_AT(info, __VA_ARGS__)
+#else
+#define LOG_I(...) (void)0
+#endif
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define LOG_W(...) LOG_AT(warn, __VA_ARGS__)
+#else
+#define LOG_W(...) (void)0
+#endif
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
+#define LOG_E(...) LOG_AT(err, __VA_ARGS__)
+#else
+#define LOG_E(...) (void)0
+#endif
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
+#define LOG_F(...) LOG_AT(critical, __VA_ARGS__)
+#else
+#define LOG_F(...) (void)0
+#endif
+
+// Initialize logger. All modules start at error level, TICTACTOE_LOG_LEVEL=<spec> overrides
+// it, see Log::setLevels().
+void init_logger(Log::Mode mode = Log::Mode::Async);
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace Metrics {
+
+// Log-linear (HDR style) histogram: every power of two range is split into kSubBucketCount
+// equal buckets, so any recorded value is known within 1/kSubBucketCount of its magnitude.
+// Written by a single thread with relaxed stores, other threads may read it at any time.
+class Histogram {
+public:
+    static constexpr unsigned kSubBucketBits = 4U;
+    static constexpr unsigned kSubBucketCount = 1U << kSubBucketBits;
+    static constexpr unsigned kMaxValueBits = 40U;     // ~18 minutes in nanoseconds
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1U) * kSubBucketCount;
+
+    using Counts = std::array<uint64_t, kBucketCount>;
+
+    static constexpr size_t bucketIndex(uint64_t value) {
+        value = std::min<uint64_t>(value, (uint64_t{1} << kMaxValueBits) - 1U);
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        const auto shift = static_cast<unsigned>(std::bit_width(value)) - 1U - kSubBucketBits;
+        const auto sub_bucket = (value >> shift) - kSubBucketCount;
+        return (shift + 1U) * kSubBucketCount + static_cast<size_t>(sub_bucket);
+    }
+
+    // Highest value which falls into the bucket
+    static constexpr uint64_t bucketUpperBound(size_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        const auto shift = static_cast<unsigned>(index / kSubBucketCount) - 1U;
+        const auto sub_bucket = index % kSubBucketCount;
+        return ((kSubBucketCount + sub_bucket + 1U) << shift) - 1U;
+    }
+
+    void record(uint64_t value) {
+        increment(counts_[bucketIndex(value)], 1U);
+        increment(count_, 1U);
+        increment(sum_, value);
+    }
+
+    // Add the current state to the merged totals of several histograms
+    void mergeInto(Counts &counts, uint64_t &count, uint64_t &sum) const {
+        for (size_t index = 0; index < kBucketCount; ++index) {
+            counts[index] += counts_[index].load(std::memory_order_relaxed);
+        }
+        count += count_.load(std::memory_order_relaxed);
+        sum += sum_.load(std::memory_order_relaxed);
+    }
+
+    // Add all values of another histogram, the caller must be the only writer of this one
+    void add(const Histogram &other) {
+        for (size_t index = 0; index < kBucketCount; ++index) {
+            increment(counts_[index], other.counts_[index].load(std::memory_order_relaxed));
+        }
+        increment(count_, other.count_.load(std::memory_order_relaxed));
+        increment(sum_, other.sum_.load(std::memory_order_relaxed));
+    }
+
+    static uint64_t quantile(const Counts &counts, uint64_t count, double quantile) {
+        if (count == 0U) {
+            return 0U;
+        }
+        const auto rank = std::max<uint64_t>(1U, static_cast<uint64_t>(quantile * static_cast<double>(count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t index = 0; index < kBucketCount; ++index) {
+            seen += counts[index];
+            if (seen >= rank) {
+                return bucketUpperBound(index);
+            }
+        }
+        return bucketUpperBound(kBucketCount - 1U);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_ {};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> sum_ = 0;
+
+    // Only the owning thread writes, so a plain load and store is enough (no locked instruction)
+    static void increment(std::atomic<uint64_t> &value, uint64_t delta) {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+};
+
+} // namespace Metrics
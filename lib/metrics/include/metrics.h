@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "player_type.h"
+
+namespace Metrics {
+
+enum class Timer : uint8_t {
+    MoveThink,      // player deciding on a move, including waiting for a human or remote peer
+    MoveUpdate,     // validating and applying the move to the board
+    RoundNotify,    // notifying players about the end of a round
+    kCount
+};
+
+enum class Counter : uint8_t {
+    Moves,
+    InvalidMoves,
+    Rounds,
+    kCount
+};
+
+// Record into the calling thread's own histograms and counters, no locks or shared writes
+void recordTime(Timer timer, PlayerKind player_kind, std::chrono::nanoseconds duration);
+void increment(Counter counter, uint64_t value = 1U);
+
+// All threads merged in Prometheus text exposition format
+std::string renderPrometheus();
+// Written to a temporary file and renamed, so readers never see a partial dump
+bool dumpToFile(const std::string &path);
+
+class IMetricsServer {
+public:
+    virtual ~IMetricsServer() = default;
+};
+
+class MetricsServerImpl;
+
+// Serves a fresh dump to every client connecting to the Unix socket,
+// e.g. `socat - UNIX-CONNECT:<path>`
+class MetricsServer : public IMetricsServer {
+public:
+    explicit MetricsServer(const std::string &socket_path);
+    ~MetricsServer() override = default;
+
+private:
+    std::unique_ptr<IMetricsServer> impl_;
+};
+
+// Measures the time from construction until destruction
+class ScopedTimer {
+public:
+    ScopedTimer(Timer timer, PlayerKind player_kind):
+            timer_(timer), player_kind_(player_kind), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        recordTime(timer_, player_kind_, std::chrono::steady_clock::now() - start_);
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    Timer timer_;
+    PlayerKind player_kind_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace Metrics
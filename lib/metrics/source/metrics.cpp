@@ -0,0 +1,292 @@
+#include "metrics.h"
+#include "histogram.h"
+#include "log.h"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Metrics {
+
+namespace {
+
+constexpr size_t kTimerCount = static_cast<size_t>(Timer::kCount);
+constexpr size_t kCounterCount = static_cast<size_t>(Counter::kCount);
+constexpr std::array<double, 5> kQuantiles = {0.5, 0.9, 0.99, 0.999, 1.0};
+
+constexpr std::array<const char *, kTimerCount> kTimerNames = {
+    "tictactoe_move_think_seconds",
+    "tictactoe_move_update_seconds",
+    "tictactoe_round_notify_seconds",
+};
+
+constexpr std::array<const char *, kTimerCount> kTimerHelp = {
+    "Time a player takes to return a move",
+    "Time spent validating and applying a move",
+    "Time spent notifying players about a finished round",
+};
+
+constexpr std::array<const char *, kCounterCount> kCounterNames = {
+    "tictactoe_moves_total",
+    "tictactoe_invalid_moves_total",
+    "tictactoe_rounds_total",
+};
+
+constexpr std::array<const char *, kPlayerKindCount> kPlayerKindNames = {"human", "bot", "remote"};
+
+// Metrics of one thread, owned by the registry until the thread exits
+struct ThreadMetrics {
+    std::array<std::array<Histogram, kPlayerKindCount>, kTimerCount> timers;
+    std::array<std::atomic<uint64_t>, kCounterCount> counters {};
+
+    void add(const ThreadMetrics &other) {
+        for (size_t timer = 0; timer < kTimerCount; ++timer) {
+            for (size_t kind = 0; kind < kPlayerKindCount; ++kind) {
+                timers[timer][kind].add(other.timers[timer][kind]);
+            }
+        }
+        for (size_t counter = 0; counter < kCounterCount; ++counter) {
+            counters[counter].store(counters[counter].load(std::memory_order_relaxed) +
+                                    other.counters[counter].load(std::memory_order_relaxed),
+                                    std::memory_order_relaxed);
+        }
+    }
+};
+
+class Registry {
+public:
+    ThreadMetrics &registerThread() {
+        std::scoped_lock<std::mutex> lock(threads_mutex_);
+        threads_.push_back(std::make_unique<ThreadMetrics>());
+        return *threads_.back();
+    }
+
+    // Fold the counts of an exiting thread into the retired totals and free its metrics
+    void retireThread(ThreadMetrics &metrics) {
+        std::scoped_lock<std::mutex> lock(threads_mutex_);
+        retired_->add(metrics);
+        std::erase_if(threads_, [&metrics](const auto &thread) {
+            return thread.get() == &metrics;
+        });
+    }
+
+    // Live threads and the retired totals, every recorded value is seen exactly once
+    template <typename Function>
+    void forEachThread(Function &&f) {
+        std::scoped_lock<std::mutex> lock(threads_mutex_);
+        f(*retired_);
+        for (const auto &thread : threads_) {
+            f(*thread);
+        }
+    }
+
+private:
+    std::mutex threads_mutex_;
+    std::vector<std::unique_ptr<ThreadMetrics>> threads_;
+    // Only written under the mutex, so the single writer rule of Histogram holds
+    std::unique_ptr<ThreadMetrics> retired_ = std::make_unique<ThreadMetrics>();
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Registers the thread on first use and retires it on thread exit
+class ThreadMetricsHandle {
+public:
+    ThreadMetricsHandle():
+            metrics_(registry().registerThread()) {}
+
+    ~ThreadMetricsHandle() {
+        registry().retireThread(metrics_);
+    }
+
+    ThreadMetricsHandle(const ThreadMetricsHandle &) = delete;
+    ThreadMetricsHandle &operator=(const ThreadMetricsHandle &) = delete;
+
+    ThreadMetrics &metrics() {
+        return metrics_;
+    }
+
+private:
+    ThreadMetrics &metrics_;
+};
+
+ThreadMetrics &threadMetrics() {
+    thread_local ThreadMetricsHandle handle;
+    return handle.metrics();
+}
+
+void appendLine(std::string &out, const char *format, auto... args) {
+    char line[256];
+    const auto size = std::snprintf(line, sizeof(line), format, args...);
+    if (size > 0) {
+        out.append(line, std::min(static_cast<size_t>(size), sizeof(line) - 1U));
+    }
+}
+
+} // namespace
+
+void recordTime(Timer timer, PlayerKind player_kind, std::chrono::nanoseconds duration) {
+    threadMetrics().timers[static_cast<size_t>(timer)][static_cast<size_t>(player_kind)].record(
+        static_cast<uint64_t>(std::max<int64_t>(0, duration.count())));
+}
+
+void increment(Counter counter, uint64_t value) {
+    auto &metric = threadMetrics().counters[static_cast<size_t>(counter)];
+    metric.store(metric.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+std::string renderPrometheus() {
+    std::string out;
+    for (size_t timer = 0; timer < kTimerCount; ++timer) {
+        appendLine(out, "# HELP %s %s\n# TYPE %s summary\n", kTimerNames[timer], kTimerHelp[timer], kTimerNames[timer]);
+        for (size_t kind = 0; kind < kPlayerKindCount; ++kind) {
+            auto counts = std::make_unique<Histogram::Counts>();
+            uint64_t count = 0;
+            uint64_t sum = 0;
+            registry().forEachThread([&](const ThreadMetrics &metrics) {
+                metrics.timers[timer][kind].mergeInto(*counts, count, sum);
+            });
+            if (count == 0U) {
+                continue;
+            }
+            for (const auto quantile : kQuantiles) {
+                appendLine(out, "%s{player=\"%s\",quantile=\"%g\"} %.9f\n", kTimerNames[timer], kPlayerKindNames[kind],
+                           quantile, static_cast<double>(Histogram::quantile(*counts, count, quantile)) * 1e-9);
+            }
+            appendLine(out, "%s_sum{player=\"%s\"} %.9f\n", kTimerNames[timer], kPlayerKindNames[kind],
+                       static_cast<double>(sum) * 1e-9);
+            appendLine(out, "%s_count{player=\"%s\"} %llu\n", kTimerNames[timer], kPlayerKindNames[kind],
+                       static_cast<unsigned long long>(count));
+        }
+    }
+    for (size_t counter = 0; counter < kCounterCount; ++counter) {
+        uint64_t total = 0;
+        registry().forEachThread([&](const ThreadMetrics &metrics) {
+            total += metrics.counters[counter].load(std::memory_order_relaxed);
+        });
+        appendLine(out, "# TYPE %s counter\n%s %llu\n", kCounterNames[counter], kCounterNames[counter],
+                   static_cast<unsigned long long>(total));
+    }
+    return out;
+}
+
+bool dumpToFile(const std::string &path) {
+    const auto text = renderPrometheus();
+    const auto temporary_path = path + ".tmp";
+    auto *file = std::fopen(temporary_path.c_str(), "w");
+    if (file == nullptr) {
+        LOG_E("Cannot open metrics file {}: {}", temporary_path, std::strerror(errno));
+        return false;
+    }
+    const auto written = std::fwrite(text.data(), 1U, text.size(), file);
+    const auto closed = std::fclose(file) == 0;
+    if (written != text.size() || !closed || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        LOG_E("Cannot write metrics file {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+class MetricsServerImpl : public IMetricsServer {
+public:
+    explicit MetricsServerImpl(const std::string &socket_path):
+            socket_path_(socket_path) {
+        sockaddr_un address {};
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("Metrics socket path is too long");
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1U);
+
+        listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ::unlink(socket_path.c_str());
+        if (listen_fd_ < 0 ||
+            ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            ::listen(listen_fd_, SOMAXCONN) != 0) {
+            LOG_E("Cannot listen on metrics socket {}: {}", socket_path, std::strerror(errno));
+            closeFds();
+            throw std::runtime_error("Cannot listen on metrics socket");
+        }
+        stop_fd_ = ::eventfd(0, EFD_CLOEXEC);
+        if (stop_fd_ < 0) {
+            closeFds();
+            throw std::runtime_error("Cannot create metrics server eventfd");
+        }
+        server_thread_ = std::thread(&MetricsServerImpl::serve, this);
+        LOG_I("Metrics served on {}", socket_path);
+    }
+
+    ~MetricsServerImpl() override {
+        const uint64_t stop = 1U;
+        std::ignore = ::write(stop_fd_, &stop, sizeof(stop));
+        server_thread_.join();
+        closeFds();
+        ::unlink(socket_path_.c_str());
+    }
+
+private:
+    std::string socket_path_;
+    int listen_fd_ = -1;
+    int stop_fd_ = -1;
+    std::thread server_thread_;
+
+    void serve() {
+        while (true) {
+            pollfd fds[] = {{listen_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_E("Metrics server poll failed: {}", std::strerror(errno));
+                return;
+            }
+            if (fds[1].revents != 0) {
+                return;
+            }
+            const int client_fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client_fd < 0) {
+                continue;
+            }
+            const auto text = renderPrometheus();
+            size_t written = 0;
+            while (written < text.size()) {
+                const auto result = ::send(client_fd, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+                if (result <= 0) {
+                    break;
+                }
+                written += static_cast<size_t>(result);
+            }
+            ::close(client_fd);
+        }
+    }
+
+    void closeFds() {
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+            listen_fd_ = -1;
+        }
+        if (stop_fd_ >= 0) {
+            ::close(stop_fd_);
+            stop_fd_ = -1;
+        }
+    }
+};
+
+MetricsServer::MetricsServer(const std::string &socket_path) :
+    impl_(std::make_unique<MetricsServerImpl>(socket_path)) {
+}
+
+} // namespace Metrics
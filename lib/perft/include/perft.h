@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "board.h"
+
+namespace Perft {
+
+constexpr size_t kCellCount = Board::kBoardSize * Board::kBoardSize;
+
+struct PerftConfig {
+    Board::BoardType board {};      // start position, X moves first so the side to move follows from it
+    size_t depth = kCellCount;      // plies to enumerate, clamped to the empty cells
+    size_t threads = 0U;            // 0 - one worker per hardware thread
+    size_t hash_megabytes = 0U;     // transposition table shared by the workers, 0 disables it
+};
+
+struct PerftResult {
+    // nodes[ply] positions reached after ply moves, nodes[0] is the start position
+    std::array<uint64_t, kCellCount + 1U> nodes {};
+    // Games which ended within the depth, a won position is not expanded further
+    uint64_t x_wins = 0U;
+    uint64_t o_wins = 0U;
+    uint64_t draws = 0U;
+    uint64_t hash_hits = 0U;
+    size_t depth = 0U;
+    size_t threads = 0U;
+    double seconds = 0.0;
+
+    uint64_t games() const {
+        return x_wins + o_wins + draws;
+    }
+
+    uint64_t totalNodes() const;
+};
+
+// Known totals of the whole 3x3 game tree from the empty board
+constexpr uint64_t kFullTreeGames = 255168U;
+constexpr uint64_t kFullTreeNodes = 549945U;
+
+class IPerft {
+public:
+    virtual ~IPerft() = default;
+    virtual PerftResult run() = 0;
+};
+
+class PerftImpl;
+
+// Counts every legal continuation of a position. The tree is split at the shallowest ply giving
+// enough subtrees for all workers, which then take subtrees from a shared index. Transpositions
+// are merged through the hash table when enabled, the counts stay the same.
+// Throws std::runtime_error for a position X and O cannot reach by alternating moves.
+class Perft : public IPerft {
+public:
+    explicit Perft(PerftConfig config);
+    ~Perft() override = default;
+
+    PerftResult run() override {
+        return impl_->run();
+    }
+
+private:
+    std::unique_ptr<IPerft> impl_;
+};
+
+} // namespace Perft
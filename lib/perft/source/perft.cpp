@@ -0,0 +1,262 @@
+#include "perft.h"
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Perft {
+
+namespace {
+
+static_assert(kCellCount * 2U <= 64U, "positions are keyed by 2 bits per cell");
+
+// Subtrees per worker when splitting, evens out their different sizes
+constexpr size_t kSubtreesPerThread = 16U;
+constexpr size_t kLockStripes = 256U;
+
+// Counts of one subtree relative to its root, nodes[0] is unused
+struct Counts {
+    std::array<uint64_t, kCellCount + 1U> nodes {};
+    uint64_t x_wins = 0U;
+    uint64_t o_wins = 0U;
+    uint64_t draws = 0U;
+
+    // Adds a child subtree rooted ply_offset moves below this one
+    void add(const Counts &child, size_t ply_offset) {
+        for (size_t ply = 1; ply + ply_offset < nodes.size(); ++ply) {
+            nodes[ply + ply_offset] += child.nodes[ply];
+        }
+        x_wins += child.x_wins;
+        o_wins += child.o_wins;
+        draws += child.draws;
+    }
+};
+
+uint64_t positionKey(const Board::BoardType &board) {
+    uint64_t key = 0U;
+    size_t shift = 0U;
+    for (const auto &row : board) {
+        for (const auto field : row) {
+            key |= static_cast<uint64_t>(field) << shift;
+            shift += 2U;
+        }
+    }
+    return key;
+}
+
+BoardPlayerType opponent(BoardPlayerType player) {
+    return player == BoardPlayerType::X ? BoardPlayerType::O : BoardPlayerType::X;
+}
+
+// Lossy, always replacing table of subtree counts. Keys are exact positions, so a hit is never
+// a different position.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t megabytes) {
+        size_t capacity = 1U;
+        while (capacity * 2U * sizeof(Entry) <= megabytes * 1024U * 1024U) {
+            capacity *= 2U;
+        }
+        entries_.resize(capacity);
+    }
+
+    bool find(uint64_t key, size_t remaining, Counts &counts) {
+        const auto index = slot(key, remaining);
+        std::scoped_lock<std::mutex> lock(stripes_[index % kLockStripes]);
+        const auto &entry = entries_[index];
+        if (entry.remaining != remaining || entry.key != key) {
+            return false;
+        }
+        counts = entry.counts;
+        return true;
+    }
+
+    void store(uint64_t key, size_t remaining, const Counts &counts) {
+        const auto index = slot(key, remaining);
+        std::scoped_lock<std::mutex> lock(stripes_[index % kLockStripes]);
+        entries_[index] = {key, remaining, counts};
+    }
+
+private:
+    struct Entry {
+        uint64_t key = 0U;
+        size_t remaining = 0U;      // 0 marks an empty entry, such subtrees are never stored
+        Counts counts;
+    };
+
+    std::vector<Entry> entries_;
+    std::array<std::mutex, kLockStripes> stripes_;
+
+    size_t slot(uint64_t key, size_t remaining) const {
+        // SplitMix64 finalizer spreads the packed cells over the whole table
+        uint64_t z = key + remaining * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+        return static_cast<size_t>(z ^ (z >> 31U)) & (entries_.size() - 1U);
+    }
+};
+
+struct Subtree {
+    Board::BoardType board;
+    BoardPlayerType side;
+};
+
+} // namespace
+
+uint64_t PerftResult::totalNodes() const {
+    uint64_t total = 0U;
+    for (size_t ply = 1; ply < nodes.size(); ++ply) {
+        total += nodes[ply];
+    }
+    return total;
+}
+
+class PerftImpl : public IPerft {
+public:
+    explicit PerftImpl(PerftConfig config) : config_(std::move(config)) {
+        size_t x_count = 0U;
+        size_t o_count = 0U;
+        for (const auto &row : config_.board) {
+            x_count += static_cast<size_t>(std::ranges::count(row, Board::BoardField::X));
+            o_count += static_cast<size_t>(std::ranges::count(row, Board::BoardField::O));
+        }
+        if (x_count != o_count && x_count != o_count + 1U) {
+            LOG_E("Perft position has {} X and {} O", x_count, o_count);
+            throw std::runtime_error("Perft position is not reachable");
+        }
+        side_ = x_count == o_count ? BoardPlayerType::X : BoardPlayerType::O;
+        config_.depth = std::min(config_.depth, kCellCount - x_count - o_count);
+        if (config_.threads == 0U) {
+            config_.threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        if (config_.hash_megabytes != 0U) {
+            table_ = std::make_unique<TranspositionTable>(config_.hash_megabytes);
+        }
+    }
+
+    PerftResult run() override {
+        const auto start = std::chrono::steady_clock::now();
+        PerftResult result;
+        result.depth = config_.depth;
+        result.threads = config_.threads;
+        result.nodes[0] = 1U;
+        hash_hits_ = 0U;
+
+        // Expand breadth first until there are enough subtrees to share out
+        Counts shallow;
+        std::vector<Subtree> subtrees;
+        size_t split_ply = 0U;
+        if (!isFinished(config_.board)) {
+            subtrees.push_back({config_.board, side_});
+        }
+        while (split_ply < config_.depth && !subtrees.empty() &&
+               subtrees.size() < config_.threads * kSubtreesPerThread) {
+            std::vector<Subtree> next;
+            ++split_ply;
+            for (auto &subtree : subtrees) {
+                for (const auto &[row, col] : Board::legalMoves(subtree.board)) {
+                    auto child = subtree;
+                    child.board[row][col] = Board::convertPlayerTypeToBoardField(subtree.side);
+                    child.side = opponent(subtree.side);
+                    ++shallow.nodes[split_ply];
+                    if (!countIfFinished(child.board, subtree.side, shallow)) {
+                        next.push_back(child);
+                    }
+                }
+            }
+            subtrees = std::move(next);
+        }
+
+        std::vector<Counts> worker_counts(config_.threads);
+        std::atomic<size_t> next_subtree = 0U;
+        const auto remaining = config_.depth - split_ply;
+        auto worker = [&](size_t worker_index) {
+            auto &counts = worker_counts[worker_index];
+            for (auto index = next_subtree.fetch_add(1U); index < subtrees.size(); index = next_subtree.fetch_add(1U)) {
+                counts.add(expand(subtrees[index].board, subtrees[index].side, remaining), split_ply);
+            }
+        };
+        if (remaining != 0U) {
+            std::vector<std::jthread> workers;
+            for (size_t index = 1; index < config_.threads; ++index) {
+                workers.emplace_back(worker, index);
+            }
+            worker(0U);
+        }
+
+        for (const auto &counts : worker_counts) {
+            shallow.add(counts, 0U);
+        }
+        for (size_t ply = 1; ply < result.nodes.size(); ++ply) {
+            result.nodes[ply] = shallow.nodes[ply];
+        }
+        result.x_wins = shallow.x_wins;
+        result.o_wins = shallow.o_wins;
+        result.draws = shallow.draws;
+        result.hash_hits = hash_hits_.load();
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        LOG_I("Perft depth {} split at ply {} into {} subtrees, {} nodes", config_.depth, split_ply,
+              subtrees.size(), result.totalNodes());
+        return result;
+    }
+
+private:
+    PerftConfig config_;
+    BoardPlayerType side_ = BoardPlayerType::X;
+    std::unique_ptr<TranspositionTable> table_;
+    std::atomic<uint64_t> hash_hits_ = 0U;
+
+    static bool isFinished(const Board::BoardType &board) {
+        return Board::isPlayerWinner(board, BoardPlayerType::X) || Board::isPlayerWinner(board, BoardPlayerType::O) ||
+               Board::isBoardFull(board);
+    }
+
+    // After mover's move, true when the game ended
+    static bool countIfFinished(const Board::BoardType &board, BoardPlayerType mover, Counts &counts) {
+        if (Board::isPlayerWinner(board, mover)) {
+            ++(mover == BoardPlayerType::X ? counts.x_wins : counts.o_wins);
+            return true;
+        }
+        if (Board::isBoardFull(board)) {
+            ++counts.draws;
+            return true;
+        }
+        return false;
+    }
+
+    // Subtree of a running game, remaining plies below it
+    Counts expand(Board::BoardType &board, BoardPlayerType side, size_t remaining) {
+        Counts counts;
+        if (remaining == 0U) {
+            return counts;
+        }
+        const auto key = table_ != nullptr ? positionKey(board) : 0U;
+        if (table_ != nullptr && table_->find(key, remaining, counts)) {
+            hash_hits_.fetch_add(1U, std::memory_order_relaxed);
+            return counts;
+        }
+        const auto field = Board::convertPlayerTypeToBoardField(side);
+        for (const auto &[row, col] : Board::legalMoves(board)) {
+            board[row][col] = field;
+            ++counts.nodes[1];
+            if (!countIfFinished(board, side, counts)) {
+                counts.add(expand(board, opponent(side), remaining - 1U), 1U);
+            }
+            board[row][col] = Board::BoardField::EMPTY;
+        }
+        if (table_ != nullptr) {
+            table_->store(key, remaining, counts);
+        }
+        return counts;
+    }
+};
+
+Perft::Perft(PerftConfig config) : impl_(std::make_unique<PerftImpl>(std::move(config))) {
+}
+
+} // namespace Perft
@@ -7,7 +7,10 @@ class ITicTacToeAlgorithm {
 public:
     virtual ~ITicTacToeAlgorithm() = default;
     virtual std::pair<int, int> getMove(const Board::BoardType& board,
-                                        BoardPlayerType bot_field) = 0;
+                                        BoardPlayerType bot_field,
+                                        const std::stop_token &stop) = 0;
+    // Positions visited by the last getMove(), 0 when it needed no search
+    virtual size_t lastSearchNodeCount() const = 0;
 };
 
 class TicTacToeAlgorithm;
@@ -16,8 +19,10 @@ class BotAlgorithm : public IBot {
 public:
     BotAlgorithm();
     virtual ~BotAlgorithm() = default;
-    std::pair<int, int> getMove(const Board::BoardType& board,
-                                BoardPlayerType bot_field) override;
+    std::pair<int, int> getMove(Board::BoardView board,
+                                BoardPlayerType bot_field,
+                                const std::stop_token &stop) override;
+    size_t lastSearchNodeCount() const;
 
 private:
     std::unique_ptr<ITicTacToeAlgorithm> algorithm_;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "board.h"
+#include "bot_interface.h"
+#include "evaluator.h"
+
+#include <memory>
+#include <stop_token>
+#include <utility>
+
+// Depth limited alpha-beta search scoring the leaves with an Eval::IEvaluator. Meant for boards
+// too large to search to the end, the evaluator follows the search with make/unmake.
+class BotEvaluator : public IBot {
+public:
+    static constexpr size_t kDefaultDepth = 4U;
+    // Positions searched between two checks of the stop token
+    static constexpr size_t kStopCheckInterval = 1024U;
+
+    BotEvaluator(std::shared_ptr<const Eval::Network> network, size_t depth);
+    virtual ~BotEvaluator() = default;
+    std::pair<int, int> getMove(Board::BoardView board,
+                                BoardPlayerType bot_field,
+                                const std::stop_token &stop) override;
+    // Positions visited by the last getMove()
+    size_t lastSearchNodeCount() const;
+
+private:
+    Eval::NetworkEvaluator evaluator_;
+    size_t depth_;
+    size_t searched_nodes_ = 0;
+    const std::stop_token *stop_ = nullptr;     // of the getMove() in progress
+    bool stopped_ = false;
+
+    int32_t negamax(Board::BoardType &board, BoardPlayerType to_move, size_t ply, int32_t alpha, int32_t beta);
+};
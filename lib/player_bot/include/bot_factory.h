@@ -4,27 +4,48 @@
 #include "bot_interface.h"
 #include "bot_random.h"
 #include "bot_algorithm.h"
+#include "bot_evaluator.h"
+#include "random.h"
 
 #include <memory>
 
 class IBotFactory {
 public:
     virtual ~IBotFactory() = default;
-    virtual std::unique_ptr<IBot> createBot() = 0;
+    // Bots drawing random numbers use only the given seed, so equal seeds give equal games
+    virtual std::unique_ptr<IBot> createBot(Random::Seed seed) = 0;
 };
 
 class BotFactoryRandom : public IBotFactory {
 public:
     BotFactoryRandom() = default;
-    inline virtual std::unique_ptr<IBot> createBot() override {
-        return std::make_unique<BotRandom>();
+    inline virtual std::unique_ptr<IBot> createBot(Random::Seed seed) override {
+        return std::make_unique<BotRandom>(seed);
     }
 };
 
 class BotFactoryAlgorithm : public IBotFactory {
 public:
     BotFactoryAlgorithm() = default;
-    inline virtual std::unique_ptr<IBot> createBot() override {
+    inline virtual std::unique_ptr<IBot> createBot(Random::Seed seed) override {
+        std::ignore = seed;
         return std::make_unique<BotAlgorithm>();
     }
 };
+
+// Evaluator bots of one factory share the network, every bot keeps its own accumulator
+class BotFactoryEvaluator : public IBotFactory {
+public:
+    explicit BotFactoryEvaluator(std::shared_ptr<const Eval::Network> network,
+                                 size_t depth = BotEvaluator::kDefaultDepth) :
+        network_(std::move(network)),
+        depth_(depth) {}
+    inline virtual std::unique_ptr<IBot> createBot(Random::Seed seed) override {
+        std::ignore = seed;
+        return std::make_unique<BotEvaluator>(network_, depth_);
+    }
+
+private:
+    std::shared_ptr<const Eval::Network> network_;
+    size_t depth_;
+};
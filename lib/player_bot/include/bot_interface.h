@@ -2,9 +2,13 @@
 
 #include "board.h"
 
+#include <stop_token>
+
 class IBot {
 public:
     virtual ~IBot() = default;
-    virtual std::pair<int, int> getMove(const Board::BoardType& board,
-                                        BoardPlayerType bot_field) = 0;
+    // Searches stop early when stop is requested, the move is Board::kInvalidMove then
+    virtual std::pair<int, int> getMove(Board::BoardView board,
+                                        BoardPlayerType bot_field,
+                                        const std::stop_token &stop) = 0;
 };
@@ -2,19 +2,18 @@
 
 #include "board.h"
 #include "bot_interface.h"
+#include "random.h"
 
-#include <random>
 #include <utility>
 
 class BotRandom : public IBot {
     public:
-        BotRandom();
+        // Deterministic bot, the same seed always plays the same sequence of moves
+        explicit BotRandom(Random::Seed seed);
         virtual ~BotRandom() = default;
-        std::pair<int, int> getMove(const Board::BoardType& board,
-                                    BoardPlayerType bot_field) override;
+        std::pair<int, int> getMove(Board::BoardView board,
+                                    BoardPlayerType bot_field,
+                                    const std::stop_token &stop) override;
     private:
-        // Create a random device and a Mersenne Twister generator seeded with it
-        std::random_device rd_;
-        std::mt19937 gen_;
-        std::uniform_int_distribution<> distrib;
+        Random::Xoshiro256pp gen_;
 };
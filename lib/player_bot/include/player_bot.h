@@ -12,11 +12,15 @@ class PlayerBotImpl;
 
 class PlayerBot : public IPlayer {
 public:
-    explicit PlayerBot(const BoardPlayerType player_type, std::unique_ptr<IBotFactory> factory);
+    PlayerBot(const BoardPlayerType player_type, std::unique_ptr<IBotFactory> factory, Random::Seed seed);
     ~PlayerBot() = default;
 
-    std::pair<int, int> get_move(const Board::Board &board) override {
-        return impl_->get_move(board);
+    std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) override {
+        return impl_->get_move(board, stop);
+    }
+
+    PlayerKind get_player_kind() const override {
+        return PlayerKind::Bot;
     }
 
     void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) override {
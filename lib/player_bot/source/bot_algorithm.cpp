@@ -2,6 +2,7 @@
 
 #include "log.h"
 #include "board.h"
+#include "trace.h"
 
 #include <utility>
 #include <ranges>
@@ -13,7 +14,10 @@ public:
     TicTacToeAlgorithm() = default;
     ~TicTacToeAlgorithm() = default;
 
-    Move getMove(const Board::BoardType& board, BoardPlayerType bot_field) override {
+    Move getMove(const Board::BoardType& board, BoardPlayerType bot_field, const std::stop_token &stop) override {
+        searched_nodes_ = 0;
+        stop_ = &stop;
+        stopped_ = false;
         bot_field_ = bot_field;
         player_field_ = (bot_field == BoardPlayerType::X) ? BoardPlayerType::O : BoardPlayerType::X;
         // Check is it possible to win
@@ -28,20 +32,34 @@ public:
         }
         // Check is it possible to make a random move
         const auto& best_move = getBestMove(board);
+        stop_ = nullptr;
+        if (stopped_) {
+            LOG_D("Bot search stopped after {} positions", searched_nodes_);
+            return Board::kInvalidMove;
+        }
         LOG_D("Bot move at ({}, {})", best_move.first, best_move.second);
         // Implement the algorithm to find the best move
         return best_move;
     }
 
+    size_t lastSearchNodeCount() const override {
+        return searched_nodes_;
+    }
+
 private:
     constexpr static int kWinScore = 10;
     constexpr static int kLoseScore = -10;
     constexpr static int kDrawScore = 0;
     constexpr static int kCenterBonus = 1;
     constexpr static int kCornerBonus = 2;
+    // Positions searched between two checks of the stop token
+    constexpr static size_t kStopCheckInterval = 1024U;
 
     BoardPlayerType player_field_ = BoardPlayerType::X;
     BoardPlayerType bot_field_ = BoardPlayerType::O;
+    size_t searched_nodes_ = 0;
+    const std::stop_token *stop_ = nullptr;     // of the getMove() in progress
+    bool stopped_ = false;
 
     std::optional<Move> checkIsWinningMove(const Board::BoardType& board, BoardPlayerType player) {
         // Check all possible moves
@@ -80,6 +98,14 @@ private:
     }
 
     int minMax(Board::BoardType board, size_t depth = 0) {
+        ++searched_nodes_;
+        // The scores of a stopped search are meaningless, unwind without expanding more positions
+        if (searched_nodes_ % kStopCheckInterval == 0U && stop_->stop_requested()) {
+            stopped_ = true;
+        }
+        if (stopped_) {
+            return kDrawScore;
+        }
         // Check if the game is over
         auto score = getLastMoveScore(board, depth);
         if (score != std::numeric_limits<int>::max()) {
@@ -137,7 +163,11 @@ private:
                         LOG_V("Error making bot move: {}", static_cast<int>(res.error()));
                         throw std::runtime_error("Error making bot move");
                     }
+                    TRACE_SPAN("bot", "search_root_move");
                     int score = minMax(board_copy.get_board());
+                    if (stopped_) {
+                        return Board::kInvalidMove;
+                    }
                     if (score > max_score) {
                         max_score = score;
                         best_move = std::make_pair(static_cast<int>(x_ind), static_cast<int>(y_ind));
@@ -155,11 +185,15 @@ BotAlgorithm::BotAlgorithm() {
     algorithm_ = std::make_unique<TicTacToeAlgorithm>();
 }
 
-Move BotAlgorithm::getMove(const Board::BoardType& board,
-                                          BoardPlayerType bot_field) {
-    std::ignore = bot_field;
-    // Generate a random move
-    const auto& move = algorithm_->getMove(board, bot_field);
+size_t BotAlgorithm::lastSearchNodeCount() const {
+    return algorithm_->lastSearchNodeCount();
+}
+
+Move BotAlgorithm::getMove(Board::BoardView board,
+                                          BoardPlayerType bot_field,
+                                          const std::stop_token &stop) {
+    // Search works on its own board copies, the view is only read
+    const auto& move = algorithm_->getMove(board.get_board(), bot_field, stop);
     LOG_D("BotAlgorithm::getMove: move = ({}, {})\n", move.first, move.second);
     return move;
 }
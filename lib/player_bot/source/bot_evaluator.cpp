@@ -0,0 +1,105 @@
+#include "bot_evaluator.h"
+
+#include "log.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Above any evaluator output, wins found earlier score higher
+constexpr int32_t kWinScore = 1 << 24;
+constexpr int32_t kInfinity = std::numeric_limits<int32_t>::max();
+
+BoardPlayerType opponent(BoardPlayerType player) {
+    return player == BoardPlayerType::X ? BoardPlayerType::O : BoardPlayerType::X;
+}
+
+} // namespace
+
+BotEvaluator::BotEvaluator(std::shared_ptr<const Eval::Network> network, size_t depth) :
+    evaluator_(std::move(network)),
+    depth_(std::max<size_t>(depth, 1U)) {
+    LOG_D("BotEvaluator created, depth {}\n", depth_);
+}
+
+size_t BotEvaluator::lastSearchNodeCount() const {
+    return searched_nodes_;
+}
+
+std::pair<int, int> BotEvaluator::getMove(Board::BoardView board,
+                                          BoardPlayerType bot_field,
+                                          const std::stop_token &stop) {
+    TRACE_SPAN("bot", "evaluator_search");
+    searched_nodes_ = 0;
+    stop_ = &stop;
+    stopped_ = false;
+    auto position = board.get_board();
+    evaluator_.reset(position);
+
+    const auto field = Board::convertPlayerTypeToBoardField(bot_field);
+    auto best_move = Board::kInvalidMove;
+    int32_t alpha = -kInfinity;
+    for (const auto &[row, col] : Board::legalMoves(position)) {
+        position[row][col] = field;
+        evaluator_.make(row, col, field);
+        const auto score = -negamax(position, opponent(bot_field), 1U, -kInfinity, -alpha);
+        evaluator_.unmake(row, col, field);
+        position[row][col] = Board::BoardField::EMPTY;
+        if (stopped_) {
+            break;
+        }
+        if (best_move == Board::kInvalidMove || score > alpha) {
+            alpha = score;
+            best_move = {row, col};
+        }
+    }
+    stop_ = nullptr;
+    if (stopped_) {
+        LOG_D("BotEvaluator search stopped after {} positions\n", searched_nodes_);
+        return Board::kInvalidMove;
+    }
+    LOG_D("BotEvaluator::getMove: move = ({}, {}) score {}\n", best_move.first, best_move.second, alpha);
+    return best_move;
+}
+
+// Score for the side to move, the opponent made the last move
+int32_t BotEvaluator::negamax(Board::BoardType &board, BoardPlayerType to_move, size_t ply, int32_t alpha,
+                              int32_t beta) {
+    ++searched_nodes_;
+    if (searched_nodes_ % kStopCheckInterval == 0U && stop_->stop_requested()) {
+        stopped_ = true;
+    }
+    if (stopped_) {
+        return 0;
+    }
+    if (Board::isPlayerWinner(board, opponent(to_move))) {
+        return -(kWinScore - static_cast<int32_t>(ply));
+    }
+    const auto moves = Board::legalMoves(board);
+    if (moves.empty()) {
+        return 0;
+    }
+    if (ply >= depth_) {
+        const auto score = evaluator_.evaluate();
+        return to_move == BoardPlayerType::X ? score : -score;
+    }
+
+    const auto field = Board::convertPlayerTypeToBoardField(to_move);
+    for (const auto &[row, col] : moves) {
+        board[row][col] = field;
+        evaluator_.make(row, col, field);
+        const auto score = -negamax(board, opponent(to_move), ply + 1U, -beta, -alpha);
+        evaluator_.unmake(row, col, field);
+        board[row][col] = Board::BoardField::EMPTY;
+        if (stopped_) {
+            return 0;
+        }
+        if (score >= beta) {
+            return score;
+        }
+        alpha = std::max(alpha, score);
+    }
+    return alpha;
+}
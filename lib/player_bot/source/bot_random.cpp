@@ -1,16 +1,19 @@
 #include "bot_random.h"
 
-constexpr size_t kMaxGeneratedNumber= 2U;
-constexpr size_t kMinGeneratedNumber= 0U;
-
-BotRandom::BotRandom():
-        gen_(rd_()) {
-    distrib = std::uniform_int_distribution<>(kMinGeneratedNumber, kMaxGeneratedNumber);
+BotRandom::BotRandom(Random::Seed seed):
+        gen_(seed) {
 }
 
-std::pair<int, int> BotRandom::getMove(const Board::BoardType& board,
-                                       BoardPlayerType bot_field) {
-    std::ignore = board;
+std::pair<int, int> BotRandom::getMove(Board::BoardView board,
+                                       BoardPlayerType bot_field,
+                                       const std::stop_token &stop) {
     std::ignore = bot_field;
-    return std::make_pair<int,int>(distrib(gen_), distrib(gen_));
+    std::ignore = stop;
+    // Pick uniformly among the empty fields, same distribution as retrying random fields
+    // until an empty one is hit, without the rejected moves
+    const auto moves = board.legal_moves();
+    if (moves.empty()) {
+        return Board::kInvalidMove;
+    }
+    return moves[Random::uniform(gen_, static_cast<uint32_t>(moves.size))];
 }
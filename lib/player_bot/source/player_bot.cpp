@@ -8,20 +8,23 @@ namespace Player
 class PlayerBotImpl : public IPlayer
 {
 public:
-    explicit PlayerBotImpl(const BoardPlayerType player_type, std::unique_ptr<IBotFactory> factory) :
+    PlayerBotImpl(const BoardPlayerType player_type, std::unique_ptr<IBotFactory> factory, Random::Seed seed) :
             IPlayer(player_type){
         // Initialize the bot algorithm
-        bot_algorithm_ = factory->createBot();
+        bot_algorithm_ = factory->createBot(seed);
     }
 
-    std::pair<int, int> get_move(const Board::Board &board) override {
-        std::ignore = board;
+    std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) override {
         const auto player_type = get_player_type();
-        const auto move = bot_algorithm_->getMove(board.get_board(), player_type);
+        const auto move = bot_algorithm_->getMove(board, player_type, stop);
         LOG_D("Bot player {} move: row: {}, col: {}", static_cast<int>(player_type), move.first, move.second);
         return  move;
     };
 
+    PlayerKind get_player_kind() const override {
+        return PlayerKind::Bot;
+    }
+
     void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) override {
         std::ignore = result;
         std::ignore = score;
@@ -33,9 +36,9 @@ private:
     std::unique_ptr<IBot> bot_algorithm_;
 };
 
-PlayerBot::PlayerBot(const BoardPlayerType player_type, std::unique_ptr<IBotFactory> factory):
+PlayerBot::PlayerBot(const BoardPlayerType player_type, std::unique_ptr<IBotFactory> factory, Random::Seed seed):
     IPlayer(player_type),
-    impl_(std::make_unique<PlayerBotImpl>(player_type, std::move(factory))) {
+    impl_(std::make_unique<PlayerBotImpl>(player_type, std::move(factory), seed)) {
 }
 
 } // namespace Player
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <utility>
+
+#include "board.h"
+
+namespace Player {
+
+// Single move mailbox shared between the thread delivering a move and the game session
+// waiting for it. The session can either block on wait() or suspend a coroutine on it.
+class MoveSlot {
+public:
+    // Store the move and wake the waiter. A suspended coroutine is resumed on the calling thread.
+    void set(std::pair<int, int> move) {
+        std::coroutine_handle<> waiter;
+        {
+            std::scoped_lock<std::mutex> lock(mutex_);
+            move_ = move;
+            // While suspend() registers its stop callback it still owns the coroutine, it sees the
+            // move and does not suspend
+            if (!registering_) {
+                waiter = std::exchange(waiter_, {});
+            }
+        }
+        move_cv_.notify_one();
+        if (waiter) {
+            waiter.resume();
+        }
+    }
+
+    // Block the calling thread until a move is delivered, empty when stop is requested first
+    std::optional<std::pair<int, int>> wait(const std::stop_token &stop) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!move_cv_.wait(lock, stop, [this] {
+            return move_.has_value();
+        })) {
+            return std::nullopt;
+        }
+        return std::exchange(move_, std::nullopt);
+    }
+
+    // Register the coroutine to resume, returns false when a move is already available. A stop
+    // request while suspended resumes the coroutine with Board::kInvalidMove on the requesting thread.
+    bool suspend(std::coroutine_handle<> waiter, const std::stop_token &stop) {
+        {
+            std::scoped_lock<std::mutex> lock(mutex_);
+            if (move_.has_value()) {
+                return false;
+            }
+            waiter_ = waiter;
+            registering_ = true;
+        }
+        // Registered outside the lock, the callback runs right here when stop was already requested
+        stop_callback_.emplace(stop, Cancel{this});
+        std::scoped_lock<std::mutex> lock(mutex_);
+        registering_ = false;
+        if (move_.has_value()) {
+            waiter_ = {};
+            return false;
+        }
+        return true;
+    }
+
+    std::pair<int, int> take() {
+        // Not under the lock, destroying the callback waits for a running one which takes it
+        stop_callback_.reset();
+        std::scoped_lock<std::mutex> lock(mutex_);
+        return *std::exchange(move_, std::nullopt);
+    }
+
+    // Drop a move nobody waits for anymore, e.g. one delivered after its session was cancelled
+    void clear() {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        move_.reset();
+    }
+
+private:
+    struct Cancel {
+        MoveSlot *slot;
+
+        void operator()() const {
+            slot->cancel();
+        }
+    };
+
+    std::mutex mutex_;
+    std::condition_variable_any move_cv_;
+    std::optional<std::pair<int, int>> move_;
+    std::coroutine_handle<> waiter_;
+    bool registering_ = false;
+    std::optional<std::stop_callback<Cancel>> stop_callback_;
+
+    // Answers a suspended waiter with kInvalidMove unless a move beat the stop request
+    void cancel() {
+        std::coroutine_handle<> waiter;
+        {
+            std::scoped_lock<std::mutex> lock(mutex_);
+            if (!waiter_ || move_.has_value()) {
+                return;
+            }
+            move_ = Board::kInvalidMove;
+            if (!registering_) {
+                waiter = std::exchange(waiter_, {});
+            }
+        }
+        if (waiter) {
+            waiter.resume();
+        }
+    }
+};
+
+// Result of IPlayer::next_move(), either an already known move or a pending MoveSlot
+class MoveAwaitable {
+public:
+    explicit MoveAwaitable(std::pair<int, int> move) : move_(move) {}
+    // The token must outlive the co_await, the engine passes the one of its coroutine frame
+    MoveAwaitable(MoveSlot &slot, const std::stop_token &stop) : slot_(&slot), stop_(&stop) {}
+
+    bool await_ready() const noexcept {
+        return slot_ == nullptr;
+    }
+
+    bool await_suspend(std::coroutine_handle<> waiter) {
+        return slot_->suspend(waiter, *stop_);
+    }
+
+    std::pair<int, int> await_resume() {
+        return slot_ != nullptr ? slot_->take() : move_;
+    }
+
+private:
+    std::pair<int, int> move_ {};
+    MoveSlot *slot_ = nullptr;
+    const std::stop_token *stop_ = nullptr;
+};
+
+} // namespace Player
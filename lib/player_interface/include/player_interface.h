@@ -1,11 +1,13 @@
 #pragma once
 
+#include <stop_token>
 #include <utility>
 
 #include "log.h"
 #include "game_result_type.h"
 #include "player_type.h"
 #include "board.h"
+#include "move_awaitable.h"
 
 namespace Player {
 
@@ -16,8 +18,15 @@ class IPlayer {
 public:
     IPlayer(BoardPlayerType player_type) : player_type_(player_type) {}
     virtual ~IPlayer() = default;
-    virtual std::pair<int, int> get_move(const Board::Board &board) = 0;
+    // Returns Board::kInvalidMove when stop is requested before the move is known
+    virtual std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) = 0;
+    // Awaitable version of get_move(), players which wait for external input override it to
+    // suspend the calling coroutine instead of blocking the thread
+    virtual MoveAwaitable next_move(Board::BoardView board, const std::stop_token &stop) {
+        return MoveAwaitable(get_move(board, stop));
+    }
     virtual void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) = 0;
+    virtual PlayerKind get_player_kind() const = 0;
     BoardPlayerType get_player_type() { return player_type_; }
 private:
     BoardPlayerType player_type_;
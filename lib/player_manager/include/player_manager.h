@@ -32,6 +32,10 @@ class PlayerManager : public IPlayerManager {
 public:
     PlayerManager(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host);
     explicit PlayerManager(TypeOfGuestPlayer type);
+    // Both players are provided by the caller, e.g. for bot vs bot self-play
+    PlayerManager(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host, std::shared_ptr<Player::IPlayer> guest);
+    // Guest of the given type, a Remote guest plays over the connected remote_socket and owns it
+    PlayerManager(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host, int remote_socket);
     ~PlayerManager() = default;
     // Get host and guest clients instances
     std::shared_ptr<Player::IPlayer> getHostClient() override {
@@ -1,7 +1,10 @@
 #include "player_manager.h"
 #include "log.h"
+#include "metrics.h"
 #include "player_bot.h"
+#include "player_remote.h"
 #include "bot_factory.h"
+#include "random.h"
 #include <unordered_map>
 #include <exception>
 
@@ -10,7 +13,7 @@ namespace PlayerManager
 
 class PlayerManagerImpl : public IPlayerManager {
 public:
-    PlayerManagerImpl(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host):
+    PlayerManagerImpl(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host, int remote_socket = -1):
             type_(type) {
         LOG_D("Selected type of guest player: {}", static_cast<int>(type));
         if (host == nullptr) {
@@ -19,7 +22,18 @@ public:
         }
         host_client_ = host;
         LOG_V("Host player created");
-        createGuestPlayer(type);
+        createGuestPlayer(type, remote_socket);
+    }
+
+    PlayerManagerImpl(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host, std::shared_ptr<Player::IPlayer> guest):
+            type_(type),
+            host_client_(std::move(host)),
+            guest_client_(std::move(guest)) {
+        LOG_D("Selected type of guest player: {}", static_cast<int>(type));
+        if (host_client_ == nullptr || guest_client_ == nullptr) {
+            LOG_E("Host or guest player is nullptr");
+            throw std::runtime_error("Host or guest player is nullptr");
+        }
     }
 
     explicit PlayerManagerImpl(TypeOfGuestPlayer type):
@@ -29,7 +43,8 @@ public:
         std::unique_ptr<IBotFactory> bot_factory_ = std::make_unique<BotFactoryRandom>();
         // Create host player
         host_client_ = std::make_shared<Player::PlayerBot>(BoardPlayerType::X,
-                                                           std::move(bot_factory_));
+                                                           std::move(bot_factory_),
+                                                           Random::seedFromEntropy());
         LOG_V("Host player created");
         createGuestPlayer(type);
     }
@@ -50,8 +65,14 @@ public:
                                std::pair<int, int> score,
                                size_t round,
                                const Board::BoardType &board) override {
-        host_client_->notifyRoundEnd(result, score, round, board);
-        guest_client_->notifyRoundEnd(result, score, round, board);
+        {
+            Metrics::ScopedTimer notify_timer(Metrics::Timer::RoundNotify, host_client_->get_player_kind());
+            host_client_->notifyRoundEnd(result, score, round, board);
+        }
+        {
+            Metrics::ScopedTimer notify_timer(Metrics::Timer::RoundNotify, guest_client_->get_player_kind());
+            guest_client_->notifyRoundEnd(result, score, round, board);
+        }
         LOG_V("Notified players about round end");
     }
 
@@ -61,13 +82,24 @@ private:
     std::shared_ptr<Player::IPlayer> host_client_;
     std::shared_ptr<Player::IPlayer> guest_client_;
 
-    void createGuestPlayer(TypeOfGuestPlayer type) {
-        std::ignore = type;
-        // Create bot factory
-        std::unique_ptr<IBotFactory> bot_factory_ = std::make_unique<BotFactoryAlgorithm>();
-        // TODO: Implement player creation based on type
-        guest_client_ = std::make_shared<Player::PlayerBot>(BoardPlayerType::O,
-                                                            std::move(bot_factory_));
+    void createGuestPlayer(TypeOfGuestPlayer type, int remote_socket = -1) {
+        switch (type) {
+            case TypeOfGuestPlayer::Bot: {
+                // Create bot factory
+                std::unique_ptr<IBotFactory> bot_factory_ = std::make_unique<BotFactoryAlgorithm>();
+                guest_client_ = std::make_shared<Player::PlayerBot>(BoardPlayerType::O,
+                                                                    std::move(bot_factory_),
+                                                                    Random::seedFromEntropy());
+                break;
+            }
+            case TypeOfGuestPlayer::Remote:
+                if (remote_socket < 0) {
+                    LOG_E("Remote guest player needs a connected socket");
+                    throw std::runtime_error("Remote guest player needs a connected socket");
+                }
+                guest_client_ = std::make_shared<Player::PlayerRemote>(BoardPlayerType::O, remote_socket);
+                break;
+        }
         LOG_V("Guest player created, type: {}", static_cast<int>(type_));
     }
 };
@@ -80,4 +112,12 @@ PlayerManager::PlayerManager(TypeOfGuestPlayer type):
 PlayerManager::PlayerManager(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host):
     impl_(std::make_unique<PlayerManagerImpl>(type, host)) {
 }
+
+PlayerManager::PlayerManager(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host, int remote_socket):
+    impl_(std::make_unique<PlayerManagerImpl>(type, host, remote_socket)) {
+}
+
+PlayerManager::PlayerManager(TypeOfGuestPlayer type, std::shared_ptr<Player::IPlayer> host, std::shared_ptr<Player::IPlayer> guest):
+    impl_(std::make_unique<PlayerManagerImpl>(type, std::move(host), std::move(guest))) {
+}
 } // namespace Player
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "player_interface.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace Player {
+
+constexpr std::chrono::milliseconds kDefaultRemoteMoveTimeout{30000};
+
+using RemoteDisconnectCallback = std::function<void()>;
+
+class PlayerRemoteImpl;
+
+// Player on the other end of a TCP connection, see wire_protocol.h for the format.
+// The socket is switched to non-blocking mode and owned by the player. get_move() waits for
+// the peer with poll() until the move arrives or stop is requested, while next_move() only
+// sends the request and leaves the socket to an event loop which calls
+// onReadable()/onWritable()/onTimeout(). A player must be driven from
+// one thread at a time. A peer which does not answer in time or disconnects plays kInvalidMove.
+class PlayerRemote : public IPlayer {
+public:
+    // session is only reported to the peer, so that spectators can ask for the game
+    PlayerRemote(BoardPlayerType player_type, int socket_fd,
+                 std::chrono::milliseconds move_timeout = kDefaultRemoteMoveTimeout, uint32_t session = 0);
+    ~PlayerRemote() override;
+
+    std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) override;
+    MoveAwaitable next_move(Board::BoardView board, const std::stop_token &stop) override;
+    void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) override;
+
+    PlayerKind get_player_kind() const override {
+        return PlayerKind::Remote;
+    }
+
+    // Event loop hooks
+    int socket() const;
+    bool is_connected() const;
+    bool wants_write() const;
+    std::optional<std::chrono::steady_clock::time_point> move_deadline() const;
+    void onReadable();
+    void onWritable();
+    void onTimeout(std::chrono::steady_clock::time_point now);
+    // Called once when the peer goes away, before a pending move request is answered with kInvalidMove
+    void setDisconnectCallback(RemoteDisconnectCallback callback);
+
+private:
+    std::unique_ptr<PlayerRemoteImpl> impl_;
+};
+
+} // namespace Player
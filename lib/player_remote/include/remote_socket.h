@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Remote {
+
+// Thin TCP helpers, all of them throw std::runtime_error on failure and return owned descriptors
+
+// Listening socket bound to address:port, port 0 picks a free port. With reuse_port several
+// sockets can listen on the same port and the kernel spreads the connections between them.
+int listenTcp(const std::string &address, uint16_t port, int backlog = 64, bool reuse_port = false);
+// Blocks until a peer connects
+int acceptTcp(int listen_fd);
+// Blocking connect, the returned socket is left in blocking mode
+int connectTcp(const std::string &address, uint16_t port);
+uint16_t localPort(int socket_fd);
+
+} // namespace Remote
@@ -0,0 +1,345 @@
+#include "player_remote.h"
+#include "wire_protocol.h"
+#include "output_batch.h"
+#include "log.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Player
+{
+
+class PlayerRemoteImpl {
+public:
+    PlayerRemoteImpl(BoardPlayerType player_type, int socket_fd, std::chrono::milliseconds move_timeout,
+                     uint32_t session) :
+            player_type_(player_type),
+            socket_fd_(socket_fd),
+            move_timeout_(move_timeout) {
+        if (socket_fd_ < 0) {
+            LOG_E("Remote player needs a connected socket");
+            throw std::runtime_error("Remote player needs a connected socket");
+        }
+        const auto flags = fcntl(socket_fd_, F_GETFL);
+        if (flags < 0 || fcntl(socket_fd_, F_SETFL, flags | O_NONBLOCK) != 0) {
+            LOG_E("Failed to make remote socket non-blocking: {}", std::strerror(errno));
+            throw std::runtime_error("Failed to make remote socket non-blocking");
+        }
+        // Not a TCP socket in tests with socketpair(), so a failure is fine here
+        const int enable = 1;
+        setsockopt(socket_fd_, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        stop_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (stop_fd_ < 0) {
+            LOG_E("Failed to create remote player stop event: {}", std::strerror(errno));
+            throw std::runtime_error("Failed to create remote player stop event");
+        }
+        Wire::encodeHello(output_.reserve(Wire::frameSize(Wire::MessageType::Hello)), player_type_,
+                          static_cast<uint32_t>(move_timeout_.count()), session);
+        flush();
+        LOG_D("Remote player {} connected, socket: {}", static_cast<int>(player_type_), socket_fd_);
+    }
+
+    ~PlayerRemoteImpl() {
+        close(stop_fd_);
+        close(socket_fd_);
+    }
+
+    std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) {
+        if (!requestMove(board)) {
+            return Board::kInvalidMove;
+        }
+        {
+            // A stop request wakes poll() through the eventfd instead of waiting for the peer. The
+            // callback is unregistered at the end of this scope, before the event is reset below.
+            std::stop_callback wake_on_stop(stop, [this] {
+                const uint64_t one = 1;
+                std::ignore = write(stop_fd_, &one, sizeof(one));
+            });
+            while (awaiting_move_ && !stop.stop_requested()) {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        deadline_ - std::chrono::steady_clock::now());
+                std::array<pollfd, 2> poll_fds {{{.fd = socket_fd_, .events = POLLIN, .revents = 0},
+                                                 {.fd = stop_fd_, .events = POLLIN, .revents = 0}}};
+                auto &poll_fd = poll_fds[0];
+                if (wants_write()) {
+                    poll_fd.events |= POLLOUT;
+                }
+                const auto ready = poll(poll_fds.data(), poll_fds.size(),
+                                        static_cast<int>(std::max<int64_t>(remaining.count(), 0)));
+                if (ready < 0 && errno != EINTR) {
+                    LOG_E("Remote player poll failed: {}", std::strerror(errno));
+                    disconnect();
+                } else if (ready == 0) {
+                    onTimeout(std::chrono::steady_clock::now());
+                } else if (ready > 0) {
+                    if ((poll_fd.revents & POLLOUT) != 0) {
+                        onWritable();
+                    }
+                    if ((poll_fd.revents & (POLLIN | POLLHUP | POLLERR)) != 0) {
+                        onReadable();
+                    }
+                }
+            }
+        }
+        uint64_t stop_events = 0;
+        std::ignore = read(stop_fd_, &stop_events, sizeof(stop_events));
+        if (awaiting_move_) {
+            // A move the peer sends late is now out of turn and dropped by parseInput(), see requestMove()
+            LOG_D("Remote player {} move abandoned, stop requested", static_cast<int>(player_type_));
+            awaiting_move_ = false;
+            received_move_.reset();
+            move_abandoned_ = true;
+            return Board::kInvalidMove;
+        }
+        return move_slot_.wait(stop).value_or(Board::kInvalidMove);
+    }
+
+    MoveAwaitable next_move(Board::BoardView board, const std::stop_token &stop) {
+        if (!requestMove(board)) {
+            return MoveAwaitable(Board::kInvalidMove);
+        }
+        return MoveAwaitable(move_slot_, stop);
+    }
+
+    void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) {
+        if (!connected_) {
+            return;
+        }
+        // Result, score and final board leave in one batch
+        Wire::encodeRoundEnd(output_.reserve(Wire::frameSize(Wire::MessageType::RoundEnd)), result,
+                             static_cast<uint32_t>(round));
+        Wire::encodeScore(output_.reserve(Wire::frameSize(Wire::MessageType::Score)), score);
+        Wire::encodeBoardState(output_.reserve(Wire::frameSize(Wire::MessageType::BoardState)), board);
+        flush();
+    }
+
+    int socket() const {
+        return socket_fd_;
+    }
+
+    bool is_connected() const {
+        return connected_;
+    }
+
+    bool wants_write() const {
+        return connected_ && !output_.empty();
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> move_deadline() const {
+        if (!awaiting_move_) {
+            return std::nullopt;
+        }
+        return deadline_;
+    }
+
+    void onReadable() {
+        while (connected_) {
+            const auto received = recv(socket_fd_, input_.data() + input_size_, input_.size() - input_size_, 0);
+            if (received > 0) {
+                input_size_ += static_cast<size_t>(received);
+                parseInput();
+                continue;
+            }
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            // A peer closing with unread data resets the connection, that is still a plain hang up
+            if (received == 0 || errno == ECONNRESET) {
+                LOG_I("Remote player {} disconnected", static_cast<int>(player_type_));
+            } else {
+                LOG_E("Remote player receive failed: {}", std::strerror(errno));
+            }
+            disconnect();
+        }
+        deliverMove();
+    }
+
+    void onWritable() {
+        flush();
+    }
+
+    void onTimeout(std::chrono::steady_clock::time_point now) {
+        if (awaiting_move_ && now >= deadline_) {
+            LOG_W("Remote player {} move timed out", static_cast<int>(player_type_));
+            received_move_ = Board::kInvalidMove;
+            deliverMove();
+        }
+    }
+
+    void setDisconnectCallback(RemoteDisconnectCallback callback) {
+        disconnect_callback_ = std::move(callback);
+    }
+
+private:
+    BoardPlayerType player_type_;
+    int socket_fd_;
+    int stop_fd_ = -1;      // eventfd waking a blocking get_move() on a stop request
+    std::chrono::milliseconds move_timeout_;
+    bool connected_ = true;
+    RemoteDisconnectCallback disconnect_callback_;
+
+    MoveSlot move_slot_;
+    bool awaiting_move_ = false;
+    bool move_abandoned_ = false;   // get_move() gave up on the last request
+    std::optional<std::pair<int, int>> received_move_;
+    std::chrono::steady_clock::time_point deadline_;
+
+    // One frame always fits, partial frames stay at the front until the rest arrives
+    std::array<uint8_t, Wire::kMaxFrameSize * 16U> input_ {};
+    size_t input_size_ = 0;
+    Wire::OutputBatch output_;
+
+    bool requestMove(Board::BoardView board) {
+        if (awaiting_move_) {
+            // A session suspended in next_move() was cancelled before the answer came
+            awaiting_move_ = false;
+            received_move_.reset();
+            move_abandoned_ = true;
+        }
+        if (std::exchange(move_abandoned_, false)) {
+            // Answers to the abandoned request which arrived meanwhile must not answer this one
+            onReadable();
+            move_slot_.clear();
+        }
+        if (!connected_) {
+            LOG_W("Remote player {} is disconnected", static_cast<int>(player_type_));
+            return false;
+        }
+        Wire::encodeMoveRequest(output_.reserve(Wire::frameSize(Wire::MessageType::MoveRequest)),
+                                board.get_board());
+        awaiting_move_ = true;
+        received_move_.reset();
+        deadline_ = std::chrono::steady_clock::now() + move_timeout_;
+        flush();
+        return true;
+    }
+
+    void parseInput() {
+        size_t offset = 0;
+        while (true) {
+            const auto parsed = Wire::parseFrame(std::span<const uint8_t>(input_.data() + offset, input_size_ - offset));
+            if (parsed.status == Wire::ParseStatus::kIncomplete) {
+                break;
+            }
+            if (parsed.status == Wire::ParseStatus::kMalformed) {
+                LOG_W("Malformed frame from remote player {}", static_cast<int>(player_type_));
+                disconnect();
+                return;
+            }
+            offset += parsed.frame.size();
+            if (parsed.frame.type != Wire::MessageType::Move) {
+                LOG_W("Unexpected message from remote player: {}", static_cast<int>(parsed.frame.type));
+            } else if (!awaiting_move_ || received_move_.has_value()) {
+                LOG_W("Remote player {} sent a move out of turn", static_cast<int>(player_type_));
+            } else {
+                received_move_ = Wire::MoveMessage{parsed.frame.payload}.move();
+            }
+        }
+        std::memmove(input_.data(), input_.data() + offset, input_size_ - offset);
+        input_size_ -= offset;
+    }
+
+    // Hands the move to the waiting session last, resuming it may already request the next move
+    void deliverMove() {
+        if (!awaiting_move_) {
+            return;
+        }
+        if (!connected_ && !received_move_.has_value()) {
+            received_move_ = Board::kInvalidMove;
+        }
+        if (received_move_.has_value()) {
+            awaiting_move_ = false;
+            move_slot_.set(*std::exchange(received_move_, std::nullopt));
+        }
+    }
+
+    void flush() {
+        if (!connected_) {
+            output_.clear();
+            return;
+        }
+        if (output_.flush(socket_fd_) == Wire::FlushResult::kError) {
+            LOG_E("Remote player {} send failed", static_cast<int>(player_type_));
+            output_.clear();
+            disconnect();
+        }
+    }
+
+    void disconnect() {
+        if (!connected_) {
+            return;
+        }
+        connected_ = false;
+        if (disconnect_callback_) {
+            disconnect_callback_();
+        }
+        deliverMove();
+    }
+};
+
+PlayerRemote::PlayerRemote(BoardPlayerType player_type, int socket_fd, std::chrono::milliseconds move_timeout,
+                           uint32_t session) :
+    IPlayer(player_type),
+    impl_(std::make_unique<PlayerRemoteImpl>(player_type, socket_fd, move_timeout, session)) {
+}
+
+PlayerRemote::~PlayerRemote() = default;
+
+std::pair<int, int> PlayerRemote::get_move(Board::BoardView board, const std::stop_token &stop) {
+    return impl_->get_move(board, stop);
+}
+
+MoveAwaitable PlayerRemote::next_move(Board::BoardView board, const std::stop_token &stop) {
+    return impl_->next_move(board, stop);
+}
+
+void PlayerRemote::notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round,
+                                  const Board::BoardType &board) {
+    impl_->notifyRoundEnd(result, score, round, board);
+}
+
+int PlayerRemote::socket() const {
+    return impl_->socket();
+}
+
+bool PlayerRemote::is_connected() const {
+    return impl_->is_connected();
+}
+
+bool PlayerRemote::wants_write() const {
+    return impl_->wants_write();
+}
+
+std::optional<std::chrono::steady_clock::time_point> PlayerRemote::move_deadline() const {
+    return impl_->move_deadline();
+}
+
+void PlayerRemote::onReadable() {
+    impl_->onReadable();
+}
+
+void PlayerRemote::onWritable() {
+    impl_->onWritable();
+}
+
+void PlayerRemote::onTimeout(std::chrono::steady_clock::time_point now) {
+    impl_->onTimeout(now);
+}
+
+void PlayerRemote::setDisconnectCallback(RemoteDisconnectCallback callback) {
+    impl_->setDisconnectCallback(std::move(callback));
+}
+
+} // namespace Player
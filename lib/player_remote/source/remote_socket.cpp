@@ -0,0 +1,95 @@
+#include "remote_socket.h"
+#include "log.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Remote
+{
+
+namespace {
+
+sockaddr_in makeAddress(const std::string &address, uint16_t port) {
+    sockaddr_in socket_address {};
+    socket_address.sin_family = AF_INET;
+    socket_address.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &socket_address.sin_addr) != 1) {
+        LOG_E("Invalid IPv4 address: {}", address);
+        throw std::runtime_error("Invalid IPv4 address: " + address);
+    }
+    return socket_address;
+}
+
+[[noreturn]] void throwSocketError(const char *what, int socket_fd) {
+    const auto error = errno;
+    if (socket_fd >= 0) {
+        close(socket_fd);
+    }
+    LOG_E("{} failed: {}", what, std::strerror(error));
+    throw std::runtime_error(std::string(what) + " failed: " + std::strerror(error));
+}
+
+} // namespace
+
+int listenTcp(const std::string &address, uint16_t port, int backlog, bool reuse_port) {
+    const auto socket_address = makeAddress(address, port);
+    const int socket_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_fd < 0) {
+        throwSocketError("socket", socket_fd);
+    }
+    const int enable = 1;
+    setsockopt(socket_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (reuse_port && setsockopt(socket_fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+        throwSocketError("SO_REUSEPORT", socket_fd);
+    }
+    if (bind(socket_fd, reinterpret_cast<const sockaddr *>(&socket_address), sizeof(socket_address)) != 0) {
+        throwSocketError("bind", socket_fd);
+    }
+    if (listen(socket_fd, backlog) != 0) {
+        throwSocketError("listen", socket_fd);
+    }
+    LOG_D("Listening on {}:{}", address, localPort(socket_fd));
+    return socket_fd;
+}
+
+int acceptTcp(int listen_fd) {
+    int socket_fd = -1;
+    do {
+        socket_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    } while (socket_fd < 0 && errno == EINTR);
+    if (socket_fd < 0) {
+        throwSocketError("accept", -1);
+    }
+    return socket_fd;
+}
+
+int connectTcp(const std::string &address, uint16_t port) {
+    const auto socket_address = makeAddress(address, port);
+    const int socket_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket_fd < 0) {
+        throwSocketError("socket", socket_fd);
+    }
+    if (connect(socket_fd, reinterpret_cast<const sockaddr *>(&socket_address), sizeof(socket_address)) != 0) {
+        throwSocketError("connect", socket_fd);
+    }
+    const int enable = 1;
+    setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    return socket_fd;
+}
+
+uint16_t localPort(int socket_fd) {
+    sockaddr_in socket_address {};
+    socklen_t length = sizeof(socket_address);
+    if (getsockname(socket_fd, reinterpret_cast<sockaddr *>(&socket_address), &length) != 0) {
+        throwSocketError("getsockname", -1);
+    }
+    return ntohs(socket_address.sin_port);
+}
+
+} // namespace Remote
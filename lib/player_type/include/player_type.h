@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 enum class BoardPlayerType : uint8_t {
@@ -7,6 +8,15 @@ enum class BoardPlayerType : uint8_t {
     O = 1
 };
 
+// Who is behind a player, used to tell apart their timings and statistics
+enum class PlayerKind : uint8_t {
+    Human = 0,
+    Bot = 1,
+    Remote = 2
+};
+
+constexpr size_t kPlayerKindCount = 3U;
+
 enum class PlayerError {
     NONE,
     INVALID_PLAYER
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace Random {
+
+using Seed = uint64_t;
+
+// SplitMix64, used to expand a single seed into generator state and to derive stream seeds
+class SplitMix64 {
+public:
+    explicit constexpr SplitMix64(uint64_t state) : state_(state) {}
+
+    constexpr uint64_t operator()() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31U);
+    }
+
+private:
+    uint64_t state_;
+};
+
+// xoshiro256++ generator: 32 bytes of state, satisfies UniformRandomBitGenerator
+class Xoshiro256pp {
+public:
+    using result_type = uint64_t;
+
+    explicit constexpr Xoshiro256pp(Seed seed) {
+        SplitMix64 seeder(seed);
+        for (auto &word : state_) {
+            word = seeder();
+        }
+    }
+
+    static constexpr result_type min() { return 0U; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() {
+        const auto result = std::rotl(state_[0] + state_[3], 23) + state_[0];
+        const auto t = state_[1] << 17U;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
+
+private:
+    uint64_t state_[4] = {};
+};
+
+// Seed of an independent stream (per thread, per bot, per game series) derived from a master seed
+constexpr Seed deriveSeed(Seed master, uint64_t stream) {
+    SplitMix64 mixer(master ^ SplitMix64(stream)());
+    return mixer();
+}
+
+// Uniform value in [0, bound) without modulo bias (Lemire's multiply and reject)
+template <typename Generator>
+constexpr uint32_t uniform(Generator &generator, uint32_t bound) {
+    auto product = static_cast<uint64_t>(static_cast<uint32_t>(generator() >> 32U)) * bound;
+    auto low = static_cast<uint32_t>(product);
+    if (low < bound) {
+        const auto threshold = static_cast<uint32_t>(-bound) % bound;
+        while (low < threshold) {
+            product = static_cast<uint64_t>(static_cast<uint32_t>(generator() >> 32U)) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32U);
+}
+
+// Non reproducible seed for interactive games, reads the OS entropy source once
+inline Seed seedFromEntropy() {
+    std::random_device device;
+    return (static_cast<Seed>(device()) << 32U) | device();
+}
+
+} // namespace Random
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SelfPlay {
+
+enum class BotKind {
+    Random,
+    Algorithm
+};
+
+struct Pairing {
+    BotKind host;
+    BotKind guest;
+};
+
+struct SelfPlayConfig {
+    std::vector<Pairing> pairings;
+    size_t games_per_pairing = 1000U;
+    size_t threads = 0U;                // 0 - one worker per hardware thread
+    uint64_t seed = 0U;                 // master seed, worker seeds are derived from it
+    size_t chunk_capacity = 65536U;     // samples per chunk
+    std::string output_path;
+};
+
+struct SelfPlayStats {
+    size_t games = 0U;
+    size_t samples = 0U;
+    size_t chunks = 0U;
+    double seconds = 0.0;
+};
+
+// Dataset file layout (little endian):
+//   file header: "TTTS" magic, version byte, board size byte, 2 reserved bytes
+//   chunks:      u32 sample count, u32 worker id, u32 chunk sequence number within the worker,
+//                then the columns stored one after another:
+//                  position u32[count] - 2 bits per cell (Board::BoardField), cell 0 in the lowest bits
+//                  move     u8[count]  - cell index played from the position
+//                  side     u8[count]  - BoardPlayerType of the player to move
+//                  outcome  i8[count]  - final result for the player to move: 1 win, 0 draw, -1 loss
+// Every worker plays a fixed share of the games with its own derived seed, so the set of chunks is
+// reproducible for a given config; only the order of chunks from different workers may vary.
+constexpr char kDatasetMagic[4] = {'T', 'T', 'T', 'S'};
+constexpr uint8_t kDatasetVersion = 1U;
+
+class ISelfPlayPipeline {
+public:
+    virtual ~ISelfPlayPipeline() = default;
+    virtual SelfPlayStats run() = 0;
+};
+
+class SelfPlayPipelineImpl;
+
+class SelfPlayPipeline : public ISelfPlayPipeline {
+public:
+    explicit SelfPlayPipeline(SelfPlayConfig config);
+    ~SelfPlayPipeline() override = default;
+
+    SelfPlayStats run() override {
+        return impl_->run();
+    }
+
+private:
+    std::unique_ptr<ISelfPlayPipeline> impl_;
+};
+
+} // namespace SelfPlay
@@ -0,0 +1,406 @@
+#include "self_play.h"
+
+#include "board.h"
+#include "bot_factory.h"
+#include "game_engine.h"
+#include "game_record.h"
+#include "log.h"
+#include "player_bot.h"
+#include "player_manager.h"
+#include "random.h"
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace SelfPlay {
+
+static_assert(std::endian::native == std::endian::little, "Dataset columns are written in host byte order");
+
+namespace {
+
+std::unique_ptr<IBotFactory> createBotFactory(BotKind kind) {
+    switch (kind) {
+    case BotKind::Random:
+        return std::make_unique<BotFactoryRandom>();
+    case BotKind::Algorithm:
+        return std::make_unique<BotFactoryAlgorithm>();
+    }
+    throw std::runtime_error("Unknown bot kind");
+}
+
+} // namespace
+
+// Column buffers of one chunk, filled by a single worker without any synchronisation
+struct SampleChunk {
+    explicit SampleChunk(size_t capacity):
+            positions(capacity), moves(capacity), sides(capacity), outcomes(capacity) {}
+
+    bool full() const {
+        return size == positions.size();
+    }
+
+    uint32_t worker_id = 0;
+    uint32_t sequence = 0;
+    size_t size = 0;
+    std::vector<uint32_t> positions;
+    std::vector<uint8_t> moves;
+    std::vector<uint8_t> sides;
+    std::vector<int8_t> outcomes;
+};
+
+// Writes finished chunks to the dataset file from a single thread, in the order they arrive.
+// A write error stops the writer, it is rethrown to the next acquire(), submit() or finish() caller.
+class DatasetWriter {
+public:
+    DatasetWriter(const std::string &path, size_t chunk_capacity):
+            chunk_capacity_(chunk_capacity) {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            LOG_E("Cannot open dataset file {}: {}", path, std::strerror(errno));
+            throw std::runtime_error("Cannot open dataset file");
+        }
+        uint8_t header[8] = {};
+        std::memcpy(header, kDatasetMagic, sizeof(kDatasetMagic));
+        header[4] = kDatasetVersion;
+        header[5] = static_cast<uint8_t>(Board::kBoardSize);
+        writeAll(header, sizeof(header));
+        writer_thread_ = std::thread(&DatasetWriter::writerLoop, this);
+    }
+
+    ~DatasetWriter() {
+        stop();
+        ::close(fd_);
+    }
+
+    // Chunks are recycled so steady state generation does not allocate
+    std::unique_ptr<SampleChunk> acquire() {
+        std::scoped_lock<std::mutex> lock(queue_mutex_);
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        if (!free_chunks_.empty()) {
+            auto chunk = std::move(free_chunks_.back());
+            free_chunks_.pop_back();
+            return chunk;
+        }
+        return std::make_unique<SampleChunk>(chunk_capacity_);
+    }
+
+    void submit(std::unique_ptr<SampleChunk> chunk) {
+        {
+            std::scoped_lock<std::mutex> lock(queue_mutex_);
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+            pending_chunks_.push_back(std::move(chunk));
+        }
+        queue_cv_.notify_one();
+    }
+
+    // Waits until every submitted chunk is written, throws the write error if there was one
+    void finish() {
+        stop();
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+    }
+
+    // Polled by the workers between moves to stop generating samples nobody can write
+    bool failed() const {
+        return failed_.load(std::memory_order_relaxed);
+    }
+
+    size_t chunksWritten() const {
+        return chunks_written_;
+    }
+
+private:
+    int fd_ = -1;
+    size_t chunk_capacity_;
+    std::thread writer_thread_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<std::unique_ptr<SampleChunk>> pending_chunks_;
+    std::vector<std::unique_ptr<SampleChunk>> free_chunks_;
+    bool is_finished_ = false;
+    std::exception_ptr error_;
+    std::atomic<bool> failed_ = false;
+    std::atomic<size_t> chunks_written_ = 0;
+
+    void stop() {
+        {
+            std::scoped_lock<std::mutex> lock(queue_mutex_);
+            is_finished_ = true;
+        }
+        queue_cv_.notify_one();
+        if (writer_thread_.joinable()) {
+            writer_thread_.join();
+        }
+    }
+
+    void writerLoop() {
+        while (true) {
+            std::unique_ptr<SampleChunk> chunk;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex_);
+                queue_cv_.wait(lock, [this] {
+                    return !pending_chunks_.empty() || is_finished_;
+                });
+                if (pending_chunks_.empty()) {
+                    return;
+                }
+                chunk = std::move(pending_chunks_.front());
+                pending_chunks_.pop_front();
+            }
+            try {
+                writeChunk(*chunk);
+            } catch (const std::exception &) {
+                // Nothing gets written after a failure, the remaining chunks are dropped
+                std::scoped_lock<std::mutex> lock(queue_mutex_);
+                error_ = std::current_exception();
+                failed_ = true;
+                pending_chunks_.clear();
+                return;
+            }
+            chunk->size = 0;
+            std::scoped_lock<std::mutex> lock(queue_mutex_);
+            free_chunks_.push_back(std::move(chunk));
+        }
+    }
+
+    void writeChunk(const SampleChunk &chunk) {
+        const uint32_t header[3] = {static_cast<uint32_t>(chunk.size), chunk.worker_id, chunk.sequence};
+        iovec columns[] = {
+            {const_cast<uint32_t *>(header), sizeof(header)},
+            {const_cast<uint32_t *>(chunk.positions.data()), chunk.size * sizeof(uint32_t)},
+            {const_cast<uint8_t *>(chunk.moves.data()), chunk.size},
+            {const_cast<uint8_t *>(chunk.sides.data()), chunk.size},
+            {const_cast<int8_t *>(chunk.outcomes.data()), chunk.size},
+        };
+        writeVectored(columns, std::size(columns));
+        ++chunks_written_;
+    }
+
+    // writev() all buffers, resuming after partial writes
+    void writeVectored(iovec *buffers, size_t count) {
+        while (count > 0U) {
+            const auto result = ::writev(fd_, buffers, static_cast<int>(count));
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_E("Dataset write failed: {}", std::strerror(errno));
+                throw std::runtime_error("Dataset write failed");
+            }
+            auto written = static_cast<size_t>(result);
+            while (count > 0U && written >= buffers->iov_len) {
+                written -= buffers->iov_len;
+                ++buffers;
+                --count;
+            }
+            if (count > 0U) {
+                buffers->iov_base = static_cast<uint8_t *>(buffers->iov_base) + written;
+                buffers->iov_len -= written;
+            }
+        }
+    }
+
+    void writeAll(void *data, size_t size) {
+        iovec buffer = {data, size};
+        writeVectored(&buffer, 1U);
+    }
+};
+
+// Receives every finished game from the engine and turns it into training samples
+class SampleCollector : public GameRecord::IGameRecordWriter {
+public:
+    SampleCollector(DatasetWriter &writer, uint32_t worker_id):
+            writer_(writer),
+            worker_id_(worker_id),
+            chunk_(writer.acquire()) {
+        chunk_->worker_id = worker_id_;
+        chunk_->sequence = next_sequence_++;
+    }
+
+    ~SampleCollector() override {
+        try {
+            flush();
+        } catch (const std::exception &) {
+            // The writer already failed, DatasetWriter::finish() reports it
+        }
+    }
+
+    void append(const GameRecord::GameRecordData &record) override {
+        const auto guest_player_type = record.host_player_type == BoardPlayerType::X ? BoardPlayerType::O
+                                                                                     : BoardPlayerType::X;
+        auto side = record.host_started ? record.host_player_type : guest_player_type;
+        auto winner = std::optional<BoardPlayerType>{};
+        if (record.result == RoundResult::HostWin) {
+            winner = record.host_player_type;
+        } else if (record.result == RoundResult::GuestWin) {
+            winner = guest_player_type;
+        }
+
+        uint32_t position = 0;
+        for (const auto move : record.moves) {
+            if (chunk_->full()) {
+                submitChunk();
+            }
+            const auto index = chunk_->size++;
+            chunk_->positions[index] = position;
+            chunk_->moves[index] = static_cast<uint8_t>(move);
+            chunk_->sides[index] = static_cast<uint8_t>(side);
+            chunk_->outcomes[index] = !winner.has_value() ? 0 : (*winner == side ? 1 : -1);
+
+            const auto field = static_cast<uint32_t>(Board::convertPlayerTypeToBoardField(side));
+            position |= field << (2U * move);
+            side = side == BoardPlayerType::X ? BoardPlayerType::O : BoardPlayerType::X;
+        }
+        samples_ += record.moves.size();
+        ++games_;
+    }
+
+    void flush() override {
+        if (chunk_ != nullptr && chunk_->size > 0U) {
+            writer_.submit(std::move(chunk_));
+        }
+    }
+
+    size_t games() const {
+        return games_;
+    }
+
+    size_t samples() const {
+        return samples_;
+    }
+
+private:
+    DatasetWriter &writer_;
+    uint32_t worker_id_;
+    uint32_t next_sequence_ = 0;
+    std::unique_ptr<SampleChunk> chunk_;
+    size_t games_ = 0;
+    size_t samples_ = 0;
+
+    void submitChunk() {
+        writer_.submit(std::move(chunk_));
+        chunk_ = writer_.acquire();
+        chunk_->worker_id = worker_id_;
+        chunk_->sequence = next_sequence_++;
+    }
+};
+
+class SelfPlayPipelineImpl : public ISelfPlayPipeline {
+public:
+    explicit SelfPlayPipelineImpl(SelfPlayConfig config):
+            config_(std::move(config)) {
+        if (config_.pairings.empty()) {
+            throw std::runtime_error("Self-play needs at least one bot pairing");
+        }
+        if (config_.chunk_capacity == 0U) {
+            throw std::runtime_error("Self-play chunk capacity must be positive");
+        }
+        if (config_.threads == 0U) {
+            config_.threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        LOG_I("Self-play pipeline: {} pairings, {} games each, {} threads",
+              config_.pairings.size(), config_.games_per_pairing, config_.threads);
+    }
+
+    SelfPlayStats run() override {
+        const auto start_time = std::chrono::steady_clock::now();
+        DatasetWriter writer(config_.output_path, config_.chunk_capacity);
+        std::vector<SelfPlayStats> worker_stats(config_.threads);
+        std::vector<std::exception_ptr> worker_errors(config_.threads);
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(config_.threads);
+            for (size_t worker_id = 0; worker_id < config_.threads; ++worker_id) {
+                workers.emplace_back([this, &writer, &worker_stats, &worker_errors, worker_id] {
+                    try {
+                        worker_stats[worker_id] = runWorker(writer, static_cast<uint32_t>(worker_id));
+                    } catch (const std::exception &) {
+                        worker_errors[worker_id] = std::current_exception();
+                    }
+                });
+            }
+        }
+        // A write error is the root cause of the workers failing to submit, report it first
+        writer.finish();
+        for (const auto &error : worker_errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        SelfPlayStats stats;
+        for (const auto &worker : worker_stats) {
+            stats.games += worker.games;
+            stats.samples += worker.samples;
+        }
+        stats.chunks = writer.chunksWritten();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        LOG_I("Self-play finished: {} games, {} samples in {:.3f} s", stats.games, stats.samples, stats.seconds);
+        return stats;
+    }
+
+private:
+    SelfPlayConfig config_;
+
+    SelfPlayStats runWorker(DatasetWriter &writer, uint32_t worker_id) {
+        Random::SplitMix64 bot_seeds(Random::deriveSeed(config_.seed, worker_id));
+        auto collector = std::make_shared<SampleCollector>(writer, worker_id);
+
+        for (const auto &pairing : config_.pairings) {
+            const auto games = gamesForWorker(worker_id);
+            if (games == 0U) {
+                continue;
+            }
+            auto host = std::make_shared<Player::PlayerBot>(BoardPlayerType::X,
+                                                            createBotFactory(pairing.host), bot_seeds());
+            auto guest = std::make_shared<Player::PlayerBot>(BoardPlayerType::O,
+                                                             createBotFactory(pairing.guest), bot_seeds());
+            auto player_manager = std::make_shared<PlayerManager::PlayerManager>(PlayerManager::TypeOfGuestPlayer::Bot,
+                                                                                 host, guest);
+            GameEngine::GameEngine engine(player_manager, Board::kBoardSize, collector);
+            size_t finished_games = 0;
+            while (finished_games < games && !writer.failed()) {
+                if (engine.processGame({}) == GameEngine::GameEngineError::kGameFinished) {
+                    ++finished_games;
+                    engine.resetGame();
+                }
+            }
+        }
+        collector->flush();
+
+        SelfPlayStats stats;
+        stats.games = collector->games();
+        stats.samples = collector->samples();
+        return stats;
+    }
+
+    // Games of every pairing are split evenly, the first workers take the remainder
+    size_t gamesForWorker(uint32_t worker_id) const {
+        const auto share = config_.games_per_pairing / config_.threads;
+        const auto remainder = config_.games_per_pairing % config_.threads;
+        return share + (worker_id < remainder ? 1U : 0U);
+    }
+};
+
+SelfPlayPipeline::SelfPlayPipeline(SelfPlayConfig config) :
+    impl_(std::make_unique<SelfPlayPipelineImpl>(std::move(config))) {
+}
+
+} // namespace SelfPlay
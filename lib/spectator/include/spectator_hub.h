@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "game_engine.h"
+
+namespace Spectator {
+
+using SubscriberId = uint64_t;
+
+constexpr size_t kDefaultMaxPendingBytes = 4096U;
+
+struct SpectatorStats {
+    size_t updates = 0;         // frames encoded, once per engine event whatever the audience
+    size_t subscribers = 0;
+    size_t snapshot_skips = 0;  // times a lagging subscriber was skipped ahead to a snapshot
+    size_t dropped = 0;
+};
+
+class SpectatorHubImpl;
+
+// Broadcasts one session to its spectators as wire protocol frames: a snapshot (board and score)
+// on subscribe, then board deltas, round ends and resets. Every engine event is encoded once
+// into a shared buffer which all subscribers reference. A subscriber with more than
+// max_pending_bytes queued loses its backlog and gets the latest snapshot once its socket drains,
+// one which keeps falling behind is dropped. Sockets are non-blocking and not owned by the hub.
+// Not thread safe, use it from the thread driving the engine.
+class SpectatorHub : public GameEngine::IGameEventListener {
+public:
+    explicit SpectatorHub(size_t max_pending_bytes = kDefaultMaxPendingBytes);
+    ~SpectatorHub() override;
+
+    void subscribe(SubscriberId id, int socket_fd);
+    void unsubscribe(SubscriberId id);
+    // The subscriber's socket is writable again
+    void onWritable(SubscriberId id);
+    // Subscribers dropped since the last call, their owner closes the sockets
+    std::vector<SubscriberId> takeDropped();
+    SpectatorStats stats() const;
+
+    void onMove(std::pair<int, int> move, BoardPlayerType player_type, size_t move_number) override;
+    void onRoundEnd(RoundResult result, std::pair<int, int> score, size_t round) override;
+    void onReset(bool host_turn, bool host_started_round) override;
+
+private:
+    std::unique_ptr<SpectatorHubImpl> impl_;
+};
+
+} // namespace Spectator
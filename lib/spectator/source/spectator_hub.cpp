@@ -0,0 +1,217 @@
+#include "spectator_hub.h"
+#include "output_batch.h"
+#include "wire_protocol.h"
+#include "log.h"
+
+#include <algorithm>
+
+namespace Spectator
+{
+
+namespace {
+
+// Lagging this many times without catching up in between gets a subscriber dropped
+constexpr size_t kMaxConsecutiveSkips = 4U;
+
+struct Subscriber {
+    SubscriberId id;
+    int socket_fd;
+    Wire::OutputBatch output;
+    bool needs_snapshot = false;
+    size_t skips = 0;
+};
+
+} // namespace
+
+class SpectatorHubImpl {
+public:
+    explicit SpectatorHubImpl(size_t max_pending_bytes) : max_pending_bytes_(max_pending_bytes) {}
+
+    void subscribe(SubscriberId id, int socket_fd) {
+        subscribers_.push_back(Subscriber{.id = id, .socket_fd = socket_fd, .output = {}});
+        auto &subscriber = subscribers_.back();
+        subscriber.output.appendShared(snapshotFrames());
+        flush(subscriber);
+        reapDropped();
+        LOG_D("Spectator {} subscribed, {} watching", id, subscribers_.size());
+    }
+
+    void unsubscribe(SubscriberId id) {
+        std::erase_if(subscribers_, [id](const Subscriber &subscriber) {
+            return subscriber.id == id;
+        });
+    }
+
+    void onWritable(SubscriberId id) {
+        const auto it = std::ranges::find(subscribers_, id, &Subscriber::id);
+        if (it == subscribers_.end()) {
+            return;
+        }
+        flush(*it);
+        if (it->needs_snapshot && it->output.empty()) {
+            it->needs_snapshot = false;
+            it->output.appendShared(snapshotFrames());
+            flush(*it);
+        }
+        reapDropped();
+    }
+
+    std::vector<SubscriberId> takeDropped() {
+        return std::exchange(dropped_, {});
+    }
+
+    SpectatorStats stats() const {
+        auto stats = stats_;
+        stats.subscribers = subscribers_.size();
+        return stats;
+    }
+
+    void onMove(std::pair<int, int> move, BoardPlayerType player_type, size_t move_number) {
+        board_[move.first][move.second] = Board::convertPlayerTypeToBoardField(player_type);
+        const auto frames = encode(Wire::MessageType::BoardDelta, [&](uint8_t *out) {
+            return Wire::encodeBoardDelta(out, move, player_type, static_cast<uint8_t>(move_number));
+        });
+        publish(frames);
+    }
+
+    void onRoundEnd(RoundResult result, std::pair<int, int> score, size_t round) {
+        score_ = score;
+        auto frames = std::make_shared<std::vector<uint8_t>>(Wire::frameSize(Wire::MessageType::RoundEnd) +
+                                                             Wire::frameSize(Wire::MessageType::Score));
+        const auto size = Wire::encodeRoundEnd(frames->data(), result, static_cast<uint32_t>(round));
+        Wire::encodeScore(frames->data() + size, score);
+        invalidateSnapshot();
+        publish(std::move(frames));
+    }
+
+    void onReset() {
+        board_ = {};
+        const auto frames = encode(Wire::MessageType::BoardState, [&](uint8_t *out) {
+            return Wire::encodeBoardState(out, board_);
+        });
+        publish(frames);
+    }
+
+private:
+    size_t max_pending_bytes_;
+    std::vector<Subscriber> subscribers_;
+    std::vector<SubscriberId> dropped_;
+    SpectatorStats stats_;
+
+    Board::BoardType board_ {};
+    std::pair<int, int> score_ {0, 0};
+    Wire::SharedFrames snapshot_;
+
+    template <typename Encoder>
+    Wire::SharedFrames encode(Wire::MessageType type, Encoder &&encoder) {
+        auto frames = std::make_shared<std::vector<uint8_t>>(Wire::frameSize(type));
+        encoder(frames->data());
+        invalidateSnapshot();
+        return frames;
+    }
+
+    void invalidateSnapshot() {
+        snapshot_.reset();
+    }
+
+    // Built lazily, so a burst of moves without new subscribers costs no snapshot encodes
+    Wire::SharedFrames snapshotFrames() {
+        if (snapshot_ == nullptr) {
+            auto frames = std::make_shared<std::vector<uint8_t>>(Wire::frameSize(Wire::MessageType::BoardState) +
+                                                                 Wire::frameSize(Wire::MessageType::Score));
+            const auto size = Wire::encodeBoardState(frames->data(), board_);
+            Wire::encodeScore(frames->data() + size, score_);
+            snapshot_ = std::move(frames);
+        }
+        return snapshot_;
+    }
+
+    void publish(const Wire::SharedFrames &frames) {
+        ++stats_.updates;
+        for (auto &subscriber : subscribers_) {
+            if (subscriber.needs_snapshot) {
+                continue;
+            }
+            subscriber.output.appendShared(frames);
+            flush(subscriber);
+        }
+        reapDropped();
+    }
+
+    void flush(Subscriber &subscriber) {
+        const auto result = subscriber.output.flush(subscriber.socket_fd);
+        if (result == Wire::FlushResult::kError) {
+            drop(subscriber);
+        } else if (result == Wire::FlushResult::kDone) {
+            if (!subscriber.needs_snapshot) {
+                subscriber.skips = 0;
+            }
+        } else if (subscriber.output.size() > max_pending_bytes_) {
+            subscriber.output.discardUnsent();
+            subscriber.needs_snapshot = true;
+            ++stats_.snapshot_skips;
+            if (++subscriber.skips > kMaxConsecutiveSkips) {
+                LOG_D("Spectator {} keeps falling behind, dropping it", subscriber.id);
+                drop(subscriber);
+            }
+        }
+    }
+
+    void drop(Subscriber &subscriber) {
+        subscriber.socket_fd = -1;
+        subscriber.output.clear();
+    }
+
+    void reapDropped() {
+        std::erase_if(subscribers_, [this](const Subscriber &subscriber) {
+            if (subscriber.socket_fd >= 0) {
+                return false;
+            }
+            dropped_.push_back(subscriber.id);
+            ++stats_.dropped;
+            return true;
+        });
+    }
+};
+
+SpectatorHub::SpectatorHub(size_t max_pending_bytes) :
+    impl_(std::make_unique<SpectatorHubImpl>(max_pending_bytes)) {
+}
+
+SpectatorHub::~SpectatorHub() = default;
+
+void SpectatorHub::subscribe(SubscriberId id, int socket_fd) {
+    impl_->subscribe(id, socket_fd);
+}
+
+void SpectatorHub::unsubscribe(SubscriberId id) {
+    impl_->unsubscribe(id);
+}
+
+void SpectatorHub::onWritable(SubscriberId id) {
+    impl_->onWritable(id);
+}
+
+std::vector<SubscriberId> SpectatorHub::takeDropped() {
+    return impl_->takeDropped();
+}
+
+SpectatorStats SpectatorHub::stats() const {
+    return impl_->stats();
+}
+
+void SpectatorHub::onMove(std::pair<int, int> move, BoardPlayerType player_type, size_t move_number) {
+    impl_->onMove(move, player_type, move_number);
+}
+
+void SpectatorHub::onRoundEnd(RoundResult result, std::pair<int, int> score, size_t round) {
+    impl_->onRoundEnd(result, score, round);
+}
+
+void SpectatorHub::onReset(bool host_turn, bool host_started_round) {
+    std::ignore = host_turn;
+    std::ignore = host_started_round;
+    impl_->onReset();
+}
+
+} // namespace Spectator
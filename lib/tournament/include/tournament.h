@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bot_factory.h"
+
+namespace Tournament {
+
+// Creates the bot factory of an entrant, bots get a seed unique per game series
+using BotFactoryCreator = std::function<std::unique_ptr<IBotFactory>()>;
+
+struct Entrant {
+    std::string name;
+    BotFactoryCreator create_factory;
+};
+
+struct TournamentConfig {
+    std::vector<Entrant> entrants;
+    size_t games_per_pair = 100U;   // split evenly between both colour assignments
+    size_t threads = 0U;            // 0 - one worker per hardware thread
+    uint64_t seed = 0U;
+};
+
+struct EntrantReport {
+    std::string name;
+    size_t games = 0U;
+    size_t wins = 0U;
+    size_t draws = 0U;
+    size_t losses = 0U;
+    double elo = 0.0;               // relative to the field average
+    double elo_error = 0.0;         // half width of the 95% confidence interval
+    size_t moves = 0U;              // get_move calls, including rejected moves
+    double mean_move_ns = 0.0;      // thread CPU time per move
+    double p99_move_ns = 0.0;
+};
+
+struct TournamentReport {
+    std::vector<EntrantReport> entrants;
+    size_t games = 0U;
+    double seconds = 0.0;
+};
+
+class ITournament {
+public:
+    virtual ~ITournament() = default;
+    virtual TournamentReport run() = 0;
+};
+
+class TournamentImpl;
+
+// Round-robin between all entrants, every pair plays half of its games with each colour
+// assignment and the engine alternates who starts every round
+class Tournament : public ITournament {
+public:
+    explicit Tournament(TournamentConfig config);
+    ~Tournament() override = default;
+
+    TournamentReport run() override {
+        return impl_->run();
+    }
+
+private:
+    std::unique_ptr<ITournament> impl_;
+};
+
+} // namespace Tournament
@@ -0,0 +1,279 @@
+#include "tournament.h"
+
+#include "board.h"
+#include "game_engine.h"
+#include "log.h"
+#include "player_bot.h"
+#include "player_manager.h"
+#include "random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <time.h>
+
+namespace Tournament {
+
+namespace {
+
+constexpr double kConfidenceZ = 1.96;           // 95% two sided
+constexpr double kMinScoreFraction = 1e-3;
+constexpr size_t kRatingIterations = 1000U;
+constexpr double kRatingTolerance = 1e-9;
+
+uint64_t threadCpuTimeNs() {
+    timespec time {};
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL + static_cast<uint64_t>(time.tv_nsec);
+}
+
+double eloFromScore(double score) {
+    score = std::clamp(score, kMinScoreFraction, 1.0 - kMinScoreFraction);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+// Measures the CPU time the wrapped player spends on every move
+class TimedPlayer : public Player::IPlayer {
+public:
+    TimedPlayer(std::shared_ptr<Player::IPlayer> player, std::vector<uint64_t> &move_costs):
+            IPlayer(player->get_player_type()),
+            player_(std::move(player)),
+            move_costs_(move_costs) {}
+
+    std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) override {
+        const auto start = threadCpuTimeNs();
+        const auto move = player_->get_move(board, stop);
+        move_costs_.push_back(threadCpuTimeNs() - start);
+        return move;
+    }
+
+    PlayerKind get_player_kind() const override {
+        return player_->get_player_kind();
+    }
+
+    void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) override {
+        player_->notifyRoundEnd(result, score, round, board);
+    }
+
+private:
+    std::shared_ptr<Player::IPlayer> player_;
+    std::vector<uint64_t> &move_costs_;
+};
+
+} // namespace
+
+// Games of one pair with a fixed colour assignment, the host plays X
+struct Series {
+    size_t host;
+    size_t guest;
+    size_t games;
+    Random::Seed seed;
+};
+
+struct SeriesResult {
+    size_t host_wins = 0U;
+    size_t guest_wins = 0U;
+    size_t draws = 0U;
+    std::vector<uint64_t> host_move_costs;
+    std::vector<uint64_t> guest_move_costs;
+};
+
+class TournamentImpl : public ITournament {
+public:
+    explicit TournamentImpl(TournamentConfig config):
+            config_(std::move(config)) {
+        if (config_.entrants.size() < 2U) {
+            throw std::runtime_error("Tournament needs at least two entrants");
+        }
+        if (config_.threads == 0U) {
+            config_.threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        uint64_t series_index = 0;
+        for (size_t first = 0; first < config_.entrants.size(); ++first) {
+            for (size_t second = first + 1U; second < config_.entrants.size(); ++second) {
+                const auto first_host_games = (config_.games_per_pair + 1U) / 2U;
+                series_.push_back({first, second, first_host_games,
+                                   Random::deriveSeed(config_.seed, series_index++)});
+                series_.push_back({second, first, config_.games_per_pair - first_host_games,
+                                   Random::deriveSeed(config_.seed, series_index++)});
+            }
+        }
+        LOG_I("Tournament: {} entrants, {} series, {} threads", config_.entrants.size(), series_.size(), config_.threads);
+    }
+
+    TournamentReport run() override {
+        const auto start_time = std::chrono::steady_clock::now();
+        std::vector<SeriesResult> results(series_.size());
+        std::atomic<size_t> next_series = 0;
+        {
+            std::vector<std::jthread> workers;
+            for (size_t worker = 0; worker < config_.threads; ++worker) {
+                workers.emplace_back([this, &results, &next_series] {
+                    for (auto index = next_series++; index < series_.size(); index = next_series++) {
+                        results[index] = playSeries(series_[index]);
+                    }
+                });
+            }
+        }
+
+        TournamentReport report;
+        report.entrants.resize(config_.entrants.size());
+        std::vector<std::vector<uint64_t>> move_costs(config_.entrants.size());
+        // points[i][j] - score of i against j, games[i][j] - games played between them
+        std::vector<std::vector<double>> points(config_.entrants.size(), std::vector<double>(config_.entrants.size()));
+        std::vector<std::vector<double>> games(config_.entrants.size(), std::vector<double>(config_.entrants.size()));
+        for (size_t index = 0; index < series_.size(); ++index) {
+            const auto &series = series_[index];
+            auto &result = results[index];
+            auto &host = report.entrants[series.host];
+            auto &guest = report.entrants[series.guest];
+            const auto series_games = result.host_wins + result.guest_wins + result.draws;
+            host.games += series_games;
+            guest.games += series_games;
+            host.wins += result.host_wins;
+            host.losses += result.guest_wins;
+            guest.wins += result.guest_wins;
+            guest.losses += result.host_wins;
+            host.draws += result.draws;
+            guest.draws += result.draws;
+            points[series.host][series.guest] += result.host_wins + 0.5 * result.draws;
+            points[series.guest][series.host] += result.guest_wins + 0.5 * result.draws;
+            games[series.host][series.guest] += series_games;
+            games[series.guest][series.host] += series_games;
+            report.games += series_games;
+            auto &host_costs = move_costs[series.host];
+            auto &guest_costs = move_costs[series.guest];
+            host_costs.insert(host_costs.end(), result.host_move_costs.begin(), result.host_move_costs.end());
+            guest_costs.insert(guest_costs.end(), result.guest_move_costs.begin(), result.guest_move_costs.end());
+        }
+
+        const auto ratings = fitRatings(points, games);
+        for (size_t entrant = 0; entrant < report.entrants.size(); ++entrant) {
+            auto &entry = report.entrants[entrant];
+            entry.name = config_.entrants[entrant].name;
+            entry.elo = ratings[entrant];
+            entry.elo_error = eloError(entry);
+            fillMoveCosts(entry, move_costs[entrant]);
+        }
+        std::ranges::sort(report.entrants, std::ranges::greater{}, &EntrantReport::elo);
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        return report;
+    }
+
+private:
+    TournamentConfig config_;
+    std::vector<Series> series_;
+
+    SeriesResult playSeries(const Series &series) {
+        SeriesResult result;
+        Random::SplitMix64 bot_seeds(series.seed);
+        auto host_bot = std::make_shared<Player::PlayerBot>(
+            BoardPlayerType::X, config_.entrants[series.host].create_factory(), bot_seeds());
+        auto guest_bot = std::make_shared<Player::PlayerBot>(
+            BoardPlayerType::O, config_.entrants[series.guest].create_factory(), bot_seeds());
+        auto player_manager = std::make_shared<PlayerManager::PlayerManager>(
+            PlayerManager::TypeOfGuestPlayer::Bot,
+            std::make_shared<TimedPlayer>(host_bot, result.host_move_costs),
+            std::make_shared<TimedPlayer>(guest_bot, result.guest_move_costs));
+        GameEngine::GameEngine engine(player_manager, Board::kBoardSize);
+
+        auto last_score = engine.getScore();
+        size_t finished_games = 0;
+        while (finished_games < series.games) {
+            if (engine.processGame({}) != GameEngine::GameEngineError::kGameFinished) {
+                continue;
+            }
+            const auto score = engine.getScore();
+            if (score.first > last_score.first) {
+                ++result.host_wins;
+            } else if (score.second > last_score.second) {
+                ++result.guest_wins;
+            } else {
+                ++result.draws;
+            }
+            last_score = score;
+            ++finished_games;
+            engine.resetGame();
+        }
+        return result;
+    }
+
+    // Bradley-Terry maximum likelihood ratings (draws count as half a win), scaled to Elo
+    // with the field average at zero. Every pair gets one virtual draw so a bot without any
+    // points still has a finite rating.
+    std::vector<double> fitRatings(const std::vector<std::vector<double>> &points,
+                                   const std::vector<std::vector<double>> &games) const {
+        const auto count = points.size();
+        std::vector<double> strength(count, 1.0);
+        for (size_t iteration = 0; iteration < kRatingIterations; ++iteration) {
+            double max_change = 0.0;
+            for (size_t i = 0; i < count; ++i) {
+                double total_points = 0.0;
+                double denominator = 0.0;
+                for (size_t j = 0; j < count; ++j) {
+                    if (i == j) {
+                        continue;
+                    }
+                    total_points += points[i][j] + 0.5;
+                    denominator += (games[i][j] + 1.0) / (strength[i] + strength[j]);
+                }
+                const auto updated = total_points / denominator;
+                max_change = std::max(max_change, std::abs(updated - strength[i]));
+                strength[i] = updated;
+            }
+            if (max_change < kRatingTolerance) {
+                break;
+            }
+        }
+        std::vector<double> ratings(count);
+        double mean = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            ratings[i] = 400.0 * std::log10(strength[i]);
+            mean += ratings[i] / static_cast<double>(count);
+        }
+        for (auto &rating : ratings) {
+            rating -= mean;
+        }
+        return ratings;
+    }
+
+    // Confidence interval of the score fraction against the field, mapped through the Elo curve
+    static double eloError(const EntrantReport &entry) {
+        if (entry.games == 0U) {
+            return 0.0;
+        }
+        const auto games = static_cast<double>(entry.games);
+        const auto score = (entry.wins + 0.5 * entry.draws) / games;
+        const auto variance = (entry.wins * std::pow(1.0 - score, 2.0) +
+                               entry.draws * std::pow(0.5 - score, 2.0) +
+                               entry.losses * std::pow(score, 2.0)) / games;
+        const auto margin = kConfidenceZ * std::sqrt(variance / games);
+        return (eloFromScore(score + margin) - eloFromScore(score - margin)) / 2.0;
+    }
+
+    static void fillMoveCosts(EntrantReport &entry, std::vector<uint64_t> &costs) {
+        entry.moves = costs.size();
+        if (costs.empty()) {
+            return;
+        }
+        double total = 0.0;
+        for (const auto cost : costs) {
+            total += static_cast<double>(cost);
+        }
+        entry.mean_move_ns = total / static_cast<double>(costs.size());
+        const auto p99_index = std::min(costs.size() - 1U, costs.size() * 99U / 100U);
+        std::nth_element(costs.begin(), costs.begin() + static_cast<std::ptrdiff_t>(p99_index), costs.end());
+        entry.p99_move_ns = static_cast<double>(costs[p99_index]);
+    }
+};
+
+Tournament::Tournament(TournamentConfig config) :
+    impl_(std::make_unique<TournamentImpl>(std::move(config))) {
+}
+
+} // namespace Tournament
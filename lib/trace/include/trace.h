@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Trace {
+
+// Recording is off until start(), a span then costs a single relaxed load.
+// With a path the trace is written there by stop() or at exit.
+void start(std::string path = {});
+void stop();
+bool enabled();
+
+// Every thread records into its own fixed buffer, a full buffer drops further events
+void recordSpan(const char *category, const char *name, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+
+enum class FlowPhase : char {
+    Begin = 's',
+    Step = 't',
+    End = 'f'
+};
+
+// Arrow between the spans enclosing the calls, e.g. from the thread handing off work to the one
+// picking it up. All phases of one arrow use the same id from newFlowId().
+uint64_t newFlowId();
+void recordFlow(const char *category, const char *name, FlowPhase phase, uint64_t id);
+
+// Shown instead of the thread number in the viewer. Only remembered by the thread until it
+// records its first event, so naming threads costs nothing while tracing is off.
+void setThreadName(std::string_view name);
+
+// Chrome trace event JSON of all threads, opens in chrome://tracing and ui.perfetto.dev.
+// Safe while threads keep recording, their later events are left out.
+std::string renderChromeTrace();
+bool writeChromeTrace(const std::string &path);
+
+// Records the time from construction until destruction. Must end on the thread it started on,
+// so never keep one across a co_await.
+class Span {
+public:
+    Span(const char *category, const char *name) : category_(category), name_(name) {
+        if (enabled()) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~Span() {
+        if (start_ != std::chrono::steady_clock::time_point {}) {
+            recordSpan(category_, name_, start_, std::chrono::steady_clock::now());
+        }
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *category_;
+    const char *name_;
+    std::chrono::steady_clock::time_point start_ {};
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Category and name must be string literals
+#ifndef TRACE_DISABLED
+#define TRACE_SPAN(category, name) Trace::Span TRACE_CONCAT(trace_span_, __LINE__)(category, name)
+#define TRACE_FLOW(category, name, phase, id) \
+    do { \
+        if (Trace::enabled()) { \
+            Trace::recordFlow(category, name, Trace::FlowPhase::phase, id); \
+        } \
+    } while (false)
+#else
+#define TRACE_SPAN(category, name) (void)0
+#define TRACE_FLOW(category, name, phase, id) (void)0
+#endif
@@ -0,0 +1,238 @@
+#include "trace.h"
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+namespace Trace {
+
+namespace {
+
+// Per thread, about 1.5 MiB allocated with the thread's first event
+constexpr size_t kEventsPerThread = 1U << 15U;
+
+struct Event {
+    const char *category;
+    const char *name;
+    int64_t start_ns;
+    int64_t duration_ns;
+    uint64_t flow_id;
+    char phase;             // 'X' complete span or a FlowPhase
+};
+
+// Written only by its thread. Events below the published count are never changed again,
+// so the exporter reads them without a lock.
+struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t id) : thread_id(id) {}
+
+    uint32_t thread_id;
+    std::string name;       // guarded by the registry mutex
+    std::unique_ptr<Event[]> events;    // published together with the first count
+    std::atomic<size_t> count = 0;
+    std::atomic<size_t> dropped = 0;
+};
+
+class Registry {
+public:
+    ThreadBuffer &registerThread(std::string_view name) {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        threads_.push_back(std::make_unique<ThreadBuffer>(static_cast<uint32_t>(threads_.size() + 1U)));
+        threads_.back()->name = name;
+        return *threads_.back();
+    }
+
+    void setName(ThreadBuffer &buffer, std::string_view name) {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        buffer.name = name;
+    }
+
+    template <typename Function>
+    void forEachThread(Function &&f) {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        for (const auto &thread : threads_) {
+            f(*thread);
+        }
+    }
+
+    std::atomic<bool> enabled = false;
+    std::atomic<uint64_t> next_flow_id = 1;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::string path;       // written by stop() and at exit
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+};
+
+Registry &registry() {
+    static Registry instance;
+    return instance;
+}
+
+// A thread is registered with its first event, until then only its name is kept here
+struct ThreadState {
+    ThreadBuffer *buffer = nullptr;
+    std::string name;
+};
+
+ThreadState &threadState() {
+    thread_local ThreadState state;
+    return state;
+}
+
+ThreadBuffer &threadBuffer() {
+    auto &state = threadState();
+    if (state.buffer == nullptr) {
+        state.buffer = &registry().registerThread(state.name);
+    }
+    return *state.buffer;
+}
+
+void append(Event event) {
+    auto &buffer = threadBuffer();
+    const auto index = buffer.count.load(std::memory_order_relaxed);
+    if (index == kEventsPerThread) {
+        buffer.dropped.fetch_add(1U, std::memory_order_relaxed);
+        return;
+    }
+    if (buffer.events == nullptr) {
+        buffer.events = std::make_unique<Event[]>(kEventsPerThread);
+    }
+    buffer.events[index] = event;
+    buffer.count.store(index + 1U, std::memory_order_release);
+}
+
+int64_t sinceEpoch(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time - registry().epoch).count();
+}
+
+void appendEvent(std::string &out, const char *format, auto... args) {
+    char line[320];
+    const auto size = std::snprintf(line, sizeof(line), format, args...);
+    if (size > 0) {
+        out.append(line, std::min(static_cast<size_t>(size), sizeof(line) - 1U));
+    }
+}
+
+void writeAtExit() {
+    stop();
+}
+
+} // namespace
+
+void start(std::string path) {
+    auto &trace = registry();
+    if (!path.empty()) {
+        static const bool exit_handler_registered = std::atexit(writeAtExit) == 0;
+        std::ignore = exit_handler_registered;
+        trace.path = std::move(path);
+    }
+    trace.enabled.store(true, std::memory_order_relaxed);
+    LOG_I("Tracing started");
+}
+
+void stop() {
+    auto &trace = registry();
+    if (!trace.enabled.exchange(false, std::memory_order_relaxed)) {
+        return;
+    }
+    LOG_I("Tracing stopped");
+    if (!trace.path.empty()) {
+        writeChromeTrace(trace.path);
+    }
+}
+
+bool enabled() {
+    return registry().enabled.load(std::memory_order_relaxed);
+}
+
+void recordSpan(const char *category, const char *name, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end) {
+    append({category, name, sinceEpoch(start), sinceEpoch(end) - sinceEpoch(start), 0U, 'X'});
+}
+
+uint64_t newFlowId() {
+    return registry().next_flow_id.fetch_add(1U, std::memory_order_relaxed);
+}
+
+void recordFlow(const char *category, const char *name, FlowPhase phase, uint64_t id) {
+    append({category, name, sinceEpoch(std::chrono::steady_clock::now()), 0, id, static_cast<char>(phase)});
+}
+
+void setThreadName(std::string_view name) {
+    auto &state = threadState();
+    state.name = name;
+    if (state.buffer != nullptr) {
+        registry().setName(*state.buffer, name);
+    }
+}
+
+std::string renderChromeTrace() {
+    const auto pid = static_cast<int>(getpid());
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&first]() {
+        return std::exchange(first, false) ? "" : ",\n";
+    };
+    registry().forEachThread([&](const ThreadBuffer &buffer) {
+        const auto count = buffer.count.load(std::memory_order_acquire);
+        if (count == 0U) {
+            return;
+        }
+        const auto name = buffer.name.empty() ? "thread-" + std::to_string(buffer.thread_id) : buffer.name;
+        appendEvent(out, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    separator(), pid, buffer.thread_id, name.c_str());
+        for (size_t index = 0; index < count; ++index) {
+            const auto &event = buffer.events[index];
+            const auto start_us = static_cast<double>(event.start_ns) * 1e-3;
+            if (event.phase == 'X') {
+                appendEvent(out, "%s{\"ph\":\"X\",\"cat\":\"%s\",\"name\":\"%s\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%u}",
+                            separator(), event.category, event.name, start_us,
+                            static_cast<double>(event.duration_ns) * 1e-3, pid, buffer.thread_id);
+            } else {
+                // The arrow ends on the span enclosing the end event instead of the next one
+                appendEvent(out, "%s{\"ph\":\"%c\",\"cat\":\"%s\",\"name\":\"%s\",\"id\":%llu,\"ts\":%.3f,\"pid\":%d,\"tid\":%u%s}",
+                            separator(), event.phase, event.category, event.name,
+                            static_cast<unsigned long long>(event.flow_id), start_us, pid, buffer.thread_id,
+                            event.phase == 'f' ? ",\"bp\":\"e\"" : "");
+            }
+        }
+        if (const auto dropped = buffer.dropped.load(std::memory_order_relaxed); dropped != 0U) {
+            LOG_W("Trace buffer of {} was full, {} events dropped", name, dropped);
+        }
+    });
+    out += "\n]}\n";
+    return out;
+}
+
+// Written to a temporary file and renamed, so readers never see a partial trace
+bool writeChromeTrace(const std::string &path) {
+    const auto text = renderChromeTrace();
+    const auto temporary_path = path + ".tmp";
+    auto *file = std::fopen(temporary_path.c_str(), "w");
+    if (file == nullptr) {
+        LOG_E("Cannot open trace file {}: {}", temporary_path, std::strerror(errno));
+        return false;
+    }
+    const auto written = std::fwrite(text.data(), 1U, text.size(), file);
+    const auto closed = std::fclose(file) == 0;
+    if (written != text.size() || !closed || std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        LOG_E("Cannot write trace file {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    LOG_I("Trace written to {}", path);
+    return true;
+}
+
+} // namespace Trace
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <istream>
+#include <memory>
+#include <utility>
+
+#include "user_interface.h"
+
+namespace UI {
+
+struct HeadlessConfig {
+    // Host moves as "row col" pairs separated by whitespace, '#' starts a comment
+    std::istream *moves = nullptr;
+    // One key=value line per round and a summary line at the end, nullptr prints nothing
+    std::FILE *output = stdout;
+    size_t max_rounds = 0;      // 0 plays until the moves run out
+};
+
+struct HeadlessResult {
+    size_t rounds = 0;
+    size_t host_wins = 0;
+    size_t guest_wins = 0;
+    size_t draws = 0;
+    size_t moves = 0;               // applied moves of both players
+    size_t rejected_moves = 0;      // host moves the engine refused, e.g. an occupied cell
+    bool input_error = false;       // the move stream was malformed, the game stopped there
+    std::pair<int, int> score = {0, 0};
+    std::chrono::nanoseconds elapsed {};
+};
+
+class IHeadlessUserInterface : public IUserInterface {
+public:
+    // Valid once startGame() returned
+    virtual HeadlessResult result() const = 0;
+};
+
+// Front end without a console for scripted and benchmark runs. The host is the same PlayerHost
+// the interactive UI uses, fed from the move stream instead of the keyboard. The game runs as
+// GameManager::playAsync() on the thread calling startGame(), every host move is answered inside
+// the turn notification, so nothing waits for a timer or a key. startGame() returns once the
+// moves run out, max_rounds were played or stopGame() was called.
+class HeadlessUserInterface : public IHeadlessUserInterface {
+public:
+    explicit HeadlessUserInterface(HeadlessConfig config);
+    ~HeadlessUserInterface() = default;
+
+    void startGame() override {
+        impl_->startGame();
+    }
+
+    void stopGame() override {
+        impl_->stopGame();
+    }
+
+    HeadlessResult result() const override {
+        return impl_->result();
+    }
+
+private:
+    std::unique_ptr<IHeadlessUserInterface> impl_;
+};
+
+} // namespace UI
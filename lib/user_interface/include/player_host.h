@@ -9,7 +9,7 @@ namespace Player {
 class PlayerHostImpl;
 
 struct UserInterfaceHostPlayerCallbacks {
-    std::function<void(const Board::Board &board)> notifyIsHostPlayerTurn;
+    std::function<void(Board::BoardView board)> notifyIsHostPlayerTurn;
     std::function<void(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board)> notifyRoundEnd;
 };
 
@@ -18,6 +18,7 @@ public:
     IHostPlayer(BoardPlayerType player_type) : IPlayer(player_type) {}
     virtual ~IHostPlayer() = default;
     virtual void setPlayerMove(std::pair<int, int> move) = 0;
+    PlayerKind get_player_kind() const override { return PlayerKind::Human; }
 };
 
 class PlayerHost : public IHostPlayer {
@@ -26,8 +27,12 @@ public:
                UserInterfaceHostPlayerCallbacks callbacks);
     ~PlayerHost() = default;
 
-    std::pair<int, int> get_move(const Board::Board &board) override {
-        return impl_->get_move(board);
+    std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) override {
+        return impl_->get_move(board, stop);
+    }
+
+    MoveAwaitable next_move(Board::BoardView board, const std::stop_token &stop) override {
+        return impl_->next_move(board, stop);
     }
 
     void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) override {
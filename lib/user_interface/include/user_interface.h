@@ -1,5 +1,10 @@
 #pragma once
 
+#include <memory>
+#include <optional>
+
+#include "game_engine.h"
+#include "journal.h"
 #include "player_interface.h"
 
 namespace UI {
@@ -15,7 +20,9 @@ class UserInterfaceImpl;
 
 class UserInterface : public IUserInterface {
 public:
-    UserInterface();
+    // With a journal the session is journaled for crash recovery, resume continues a recovered session
+    explicit UserInterface(std::shared_ptr<Journal::IJournalWriter> journal = nullptr,
+                           std::optional<GameEngine::Snapshot> resume = std::nullopt);
     ~UserInterface() = default;
     void startGame() override {
         impl_->startGame();
@@ -0,0 +1,207 @@
+#include "headless_interface.h"
+#include "log.h"
+#include "game_manager.h"
+#include "player_host.h"
+#include "board.h"
+#include "task.h"
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace UI
+{
+
+namespace {
+
+const char *roundResultName(RoundResult result) {
+    switch (result) {
+        case RoundResult::HostWin: return "host_win";
+        case RoundResult::GuestWin: return "guest_win";
+        case RoundResult::Draw: return "draw";
+        default: return "unknown";
+    }
+}
+
+// Counts the moves the engine applied, the host's own ones separately
+class MoveCounter : public GameEngine::IGameEventListener {
+public:
+    void onMove(std::pair<int, int>, BoardPlayerType player_type, size_t) override {
+        ++moves;
+        if (player_type == BoardPlayerType::X) {
+            ++host_moves;
+        }
+    }
+
+    void onRoundEnd(RoundResult, std::pair<int, int>, size_t) override {
+    }
+
+    void onReset(bool, bool) override {
+    }
+
+    size_t moves = 0;
+    size_t host_moves = 0;
+};
+
+} // namespace
+
+class HeadlessUserInterfaceImpl : public IHeadlessUserInterface {
+public:
+    explicit HeadlessUserInterfaceImpl(HeadlessConfig config) : config_(std::move(config)) {
+        if (config_.moves == nullptr) {
+            LOG_E("Headless UI needs a move stream");
+            throw std::runtime_error("Headless UI needs a move stream");
+        }
+        Player::UserInterfaceHostPlayerCallbacks callbacks = {
+            .notifyIsHostPlayerTurn = std::bind(&HeadlessUserInterfaceImpl::answerHostTurn,
+                                                this, std::placeholders::_1),
+            .notifyRoundEnd = std::bind(&HeadlessUserInterfaceImpl::recordRoundEnd,
+                                        this, std::placeholders::_1,
+                                        std::placeholders::_2,
+                                        std::placeholders::_3,
+                                        std::placeholders::_4)
+        };
+        player_host_ = std::make_shared<Player::PlayerHost>(BoardPlayerType::X, std::move(callbacks));
+        game_manager_ = std::make_unique<GameManager::GameManager>(player_host_);
+        game_manager_->addEventListener(move_counter_);
+        LOG_D("Headless user interface created");
+    }
+
+    ~HeadlessUserInterfaceImpl() override {
+        LOG_D("Headless user interface destroyed");
+    }
+
+    void startGame() override {
+        LOG_I("Starting headless game");
+        const auto start = std::chrono::steady_clock::now();
+        bool finished = false;
+        std::exception_ptr failure;
+        // Every move is answered before the engine awaits it, so the whole game runs right here
+        Coro::spawn(game_manager_->playAsync(), [&](std::exception_ptr error) {
+            failure = error;
+            finished = true;
+        });
+        if (!finished) {
+            LOG_E("Headless game suspended on a move");
+            throw std::runtime_error("Headless game suspended on a move");
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        result_.elapsed = std::chrono::steady_clock::now() - start;
+        result_.moves = move_counter_->moves;
+        result_.rejected_moves = host_moves_sent_ - move_counter_->host_moves;
+        printSummary();
+        LOG_I("Headless game stopped after {} rounds", result_.rounds);
+    }
+
+    void stopGame() override {
+        LOG_D("Stopping headless game");
+        stop_requested_.store(true, std::memory_order_release);
+        game_manager_->stopGame();
+    }
+
+    HeadlessResult result() const override {
+        return result_;
+    }
+
+private:
+    HeadlessConfig config_;
+    std::shared_ptr<Player::IHostPlayer> player_host_;
+    std::unique_ptr<GameManager::GameManager> game_manager_;
+    std::shared_ptr<MoveCounter> move_counter_ = std::make_shared<MoveCounter>();
+    std::atomic<bool> stop_requested_ = false;
+
+    // Move stream position
+    std::istringstream line_;
+    size_t line_number_ = 0;
+
+    size_t host_moves_sent_ = 0;
+    HeadlessResult result_;
+
+    // Called on the game thread before the engine awaits the host move
+    void answerHostTurn(Board::BoardView) {
+        const auto move = stop_requested_.load(std::memory_order_acquire) ? std::nullopt : nextMove();
+        if (!move.has_value()) {
+            // The engine refuses the invalid move and the game loop sees the stop
+            stopGame();
+            player_host_->setPlayerMove(Board::kInvalidMove);
+            return;
+        }
+        ++host_moves_sent_;
+        player_host_->setPlayerMove(*move);
+    }
+
+    void recordRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) {
+        ++result_.rounds;
+        switch (result) {
+            case RoundResult::HostWin: ++result_.host_wins; break;
+            case RoundResult::GuestWin: ++result_.guest_wins; break;
+            default: ++result_.draws; break;
+        }
+        result_.score = score;
+        if (config_.output != nullptr) {
+            std::string cells;
+            for (const auto &row : board) {
+                for (const auto field : row) {
+                    const auto symbol = Board::convertBoardFieldToChar(field);
+                    cells += symbol == ' ' ? '.' : symbol;
+                }
+            }
+            // The manager passes the number of the round which starts next
+            std::fprintf(config_.output, "round=%zu result=%s host_score=%d guest_score=%d board=%s\n",
+                         round - 1U, roundResultName(result), score.first, score.second, cells.c_str());
+        }
+        if (config_.max_rounds != 0U && result_.rounds >= config_.max_rounds) {
+            stopGame();
+        }
+    }
+
+    std::optional<std::pair<int, int>> nextMove() {
+        while (true) {
+            line_ >> std::ws;
+            if (!line_.eof()) {
+                int row = 0;
+                int col = 0;
+                if (line_ >> row >> col) {
+                    return std::make_pair(row, col);
+                }
+                LOG_E("Malformed move on line {}", line_number_);
+                result_.input_error = true;
+                return std::nullopt;
+            }
+            std::string text;
+            if (!std::getline(*config_.moves, text)) {
+                return std::nullopt;
+            }
+            ++line_number_;
+            text.erase(std::min(text.find('#'), text.size()));
+            line_.clear();
+            line_.str(text);
+        }
+    }
+
+    void printSummary() const {
+        if (config_.output == nullptr) {
+            return;
+        }
+        const auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(result_.elapsed).count();
+        const double seconds = std::chrono::duration<double>(result_.elapsed).count();
+        std::fprintf(config_.output,
+                     "rounds=%zu host_wins=%zu guest_wins=%zu draws=%zu host_score=%d guest_score=%d moves=%zu "
+                     "rejected_moves=%zu input_error=%d elapsed_us=%lld moves_per_second=%.0f\n",
+                     result_.rounds, result_.host_wins, result_.guest_wins, result_.draws, result_.score.first,
+                     result_.score.second, result_.moves, result_.rejected_moves, result_.input_error ? 1 : 0,
+                     static_cast<long long>(elapsed_us), seconds > 0.0 ? static_cast<double>(result_.moves) / seconds : 0.0);
+        std::fflush(config_.output);
+    }
+};
+
+HeadlessUserInterface::HeadlessUserInterface(HeadlessConfig config):
+    impl_(std::make_unique<HeadlessUserInterfaceImpl>(std::move(config))) {
+}
+
+} // namespace UI
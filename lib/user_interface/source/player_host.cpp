@@ -1,8 +1,9 @@
 #include "player_host.h"
 #include "log.h"
 #include "board.h"
-#include <mutex>
-#include <condition_variable>
+#include "trace.h"
+
+#include <atomic>
 
 namespace Player
 {
@@ -25,24 +26,28 @@ public:
         setPlayerMove(Board::kInvalidMove); // Notify that the player is no longer available
     }
 
-    std::pair<int, int> get_move(const Board::Board &board) override {
+    std::pair<int, int> get_move(Board::BoardView board, const std::stop_token &stop) override {
         LOG_D("PlayerHostImpl::get_move called");
-        if (callbacks_.notifyIsHostPlayerTurn) {
-            callbacks_.notifyIsHostPlayerTurn(board);
-        } else {
-            LOG_E("notifyIsHostPlayerTurn callback is not set");
-            throw std::runtime_error("notifyIsHostPlayerTurn callback is not set");
-        }
+        notifyHostPlayerTurn(board);
 
         // Wait for the player to set the move
         LOG_D("Waiting for player move");
-        std::unique_lock<std::mutex> lock(player_move_mutex_);
-        player_move_cv_.wait(lock, [this] {
-            return is_player_move_set_;
-        });
-        LOG_D("Player move received ({}, {})", player_move_.first, player_move_.second);
-        is_player_move_set_ = false; // Reset the flag for the next move
-        return player_move_;
+        TRACE_SPAN("ui", "wait_player_move");
+        const auto player_move = player_move_slot_.wait(stop);
+        if (!player_move.has_value()) {
+            LOG_D("Player move abandoned, stop requested");
+            return Board::kInvalidMove;
+        }
+        TRACE_FLOW("ui", "host_move", End, move_flow_id_.load(std::memory_order_relaxed));
+        LOG_D("Player move received ({}, {})", player_move->first, player_move->second);
+        return *player_move;
+    }
+
+    MoveAwaitable next_move(Board::BoardView board, const std::stop_token &stop) override {
+        LOG_D("PlayerHostImpl::next_move called");
+        notifyHostPlayerTurn(board);
+        // The awaiting coroutine is resumed by the thread calling setPlayerMove(), or by a stop request
+        return MoveAwaitable(player_move_slot_, stop);
     }
 
     void notifyRoundEnd(RoundResult result, std::pair<int, int> score, size_t round, const Board::BoardType &board) override {
@@ -57,20 +62,27 @@ public:
 
     void setPlayerMove(std::pair<int, int> move) override {
         LOG_D("PlayerHostImpl::setPlayerMove called ({}, {})", move.first, move.second);
-        std::unique_lock<std::mutex> lock(player_move_mutex_);
-        player_move_ = move;
-        is_player_move_set_ = true;
-        lock.unlock(); // Unlock the mutex before notifying
-        player_move_cv_.notify_one(); // Notify the waiting thread
+        TRACE_FLOW("ui", "host_move", Step, move_flow_id_.load(std::memory_order_relaxed));
+        player_move_slot_.set(move); // Wake the waiting thread or resume the waiting session
     }
 
 private:
     UserInterfaceHostPlayerCallbacks callbacks_;
 
-    std::mutex player_move_mutex_;
-    bool is_player_move_set_ = false;
-    std::condition_variable player_move_cv_;
-    std::pair<int, int> player_move_ {0, 0};
+    MoveSlot player_move_slot_;
+    // Links the turn notification, the UI thread answering it and the game thread taking the move
+    std::atomic<uint64_t> move_flow_id_ = 0;
+
+    void notifyHostPlayerTurn(Board::BoardView board) {
+        move_flow_id_.store(Trace::newFlowId(), std::memory_order_relaxed);
+        TRACE_FLOW("ui", "host_move", Begin, move_flow_id_.load(std::memory_order_relaxed));
+        if (callbacks_.notifyIsHostPlayerTurn) {
+            callbacks_.notifyIsHostPlayerTurn(board);
+        } else {
+            LOG_E("notifyIsHostPlayerTurn callback is not set");
+            throw std::runtime_error("notifyIsHostPlayerTurn callback is not set");
+        }
+    }
 };
 
 PlayerHost::PlayerHost(BoardPlayerType player_type,
@@ -4,12 +4,13 @@
 #include "player_host.h"
 #include "console_manager.h"
 #include "board.h"
+#include "mpsc_ring_buffer.h"
+#include "trace.h"
 
+#include <atomic>
 #include <cstdlib>
 #include <iostream>
 #include <mutex>
-#include <semaphore>
-#include <queue>
 
 namespace UI
 {
@@ -21,11 +22,13 @@ enum class UIEventType {
     kInvalidEvent
 };
 
-constexpr size_t kMaxEventCount = 10U;
+constexpr size_t kMaxEventCount = 16U;
+// The local game is the only session in its journal
+constexpr uint32_t kJournalSession = 0U;
 
 class UserInterfaceImpl : public IUserInterface {
 public:
-    UserInterfaceImpl() {
+    UserInterfaceImpl(std::shared_ptr<Journal::IJournalWriter> journal, std::optional<GameEngine::Snapshot> resume) {
         Player::UserInterfaceHostPlayerCallbacks callbacks = {
             .notifyIsHostPlayerTurn = std::bind(&UserInterfaceImpl::listenForHostPlayerMove,
                                                 this, std::placeholders::_1),
@@ -38,7 +41,20 @@ public:
         console_manager_ = std::make_unique<ConsoleManager>();
         player_host_ = std::make_shared<Player::PlayerHost>(BoardPlayerType::X,
                                                             std::move(callbacks));
-        game_manager_ = std::make_unique<GameManager::GameManager>(player_host_);
+        if (resume.has_value()) {
+            game_manager_ = std::make_unique<GameManager::GameManager>(player_host_, *resume);
+            if (const auto state = GameEngine::decodeSnapshot(*resume)) {
+                game_score_ = {static_cast<int>(state->host_score), static_cast<int>(state->guest_score)};
+                game_round_ = state->rounds_played + 1U;
+            }
+            LOG_I("Resuming game from journal");
+        } else {
+            game_manager_ = std::make_unique<GameManager::GameManager>(player_host_);
+        }
+        if (journal != nullptr) {
+            game_manager_->addEventListener(
+                std::make_shared<Journal::SessionJournal>(journal, kJournalSession, game_manager_->snapshot()));
+        }
         LOG_D("User interface created");
     }
 
@@ -49,28 +65,35 @@ public:
 
     void startGame() override {
         LOG_I("Starting game");
+        Trace::setThreadName("ui");
         game_manager_->startGame();
         this->processGame();
     }
 
     void stopGame() override {
         LOG_D("Stopping game");
-        addNewEvent(UIEventType::GameEnd);
+        // May be called from the UI thread itself, so never block on a full queue here;
+        // the flag is checked after every processed event
+        game_end_requested_.store(true, std::memory_order_release);
+        std::ignore = event_queue_.tryPush(UIEventType::GameEnd);
+        console_manager_->interrupt();
         game_manager_->stopGame();
     }
 
 
 private:
     std::shared_ptr<Player::IHostPlayer> player_host_;
-    std::unique_ptr<GameManager::GameManager> game_manager_;
+    // Outlives the game manager, its threads wake the console until they are joined
     std::unique_ptr<ConsoleManager::IConsoleManager> console_manager_;
+    std::unique_ptr<GameManager::GameManager> game_manager_;
 
     // variables used for event handling
     std::mutex player_move_mutex_;
     std::mutex game_stat_update_mutex_;
-    std::mutex event_queue_mutex_;
-    std::queue<UIEventType> event_queue_;
-    std::counting_semaphore<kMaxEventCount> event_semaphore_{0};
+    Concurrency::MpscRingBuffer<UIEventType, kMaxEventCount> event_queue_;
+    std::atomic<bool> game_end_requested_ = false;
+    // The host player is to move, keys are read whenever no event waits
+    bool move_pending_ = false;
 
     // copy of the game board
     Board::BoardType game_board_ = {};
@@ -80,7 +103,7 @@ private:
     size_t game_round_ = 1;
     RoundResult last_round_result_ = RoundResult::Draw;
 
-    void listenForHostPlayerMove(const Board::Board &board) {
+    void listenForHostPlayerMove(Board::BoardView board) {
         std::ignore = board; // Ignore the board for now
         LOG_D("Host player turn notified");
         {
@@ -109,9 +132,13 @@ private:
     }
 
     void getPlayerMove() {
+        TRACE_SPAN("ui", "read_player_move");
         try {
-            auto player_move = console_manager_->getPlayerMove(getGameBoard());
-            player_host_->setPlayerMove(player_move); // Replace with actual move
+            const auto player_move = console_manager_->getPlayerMove(getGameBoard());
+            if (player_move.has_value()) {
+                move_pending_ = false;
+                player_host_->setPlayerMove(*player_move);
+            }
         } catch (const std::exception &e) {
             LOG_I("Catched exception: {}", e.what());
             stopGame(); // Stop the game on error
@@ -121,8 +148,7 @@ private:
     void processGame() {
         auto game_finished = false;
         while (!game_finished) {
-            // Clear console before printing the board and score
-            console_manager_->clearConsole();
+            // Only the stats line is redrawn, and only when it changed
             {
                 std::scoped_lock<std::mutex> lock(game_stat_update_mutex_);
                 // Print game stats
@@ -130,50 +156,54 @@ private:
                                                  game_score_.second,
                                                  game_round_);
             }
-            const auto event = getNextEvent();
-            switch (event) {
-                case UIEventType::PlayerMove: // Get player move
-                    getPlayerMove();
-                    break;
-                case UIEventType::RoundEnd:  // Print game stats
-                    console_manager_->printRoundEndMessage(getGameBoard(),
-                                                           last_round_result_,
-                                                           game_round_ - 1);    // Decrement round for display
-                    break;
-                case UIEventType::GameEnd:
-                    console_manager_->gameEndMessage(); // Print game end message
-                    game_finished = true; // Set game finished flag
-                    break;
-                default:
-                    LOG_E("Invalid event type: {}", static_cast<int>(event));
-                    break;
+            // Key presses and events are waited for together, an event wakes the console
+            std::optional<UIEventType> next_event = event_queue_.tryPop();
+            if (!next_event.has_value() && move_pending_) {
+                getPlayerMove();
+            } else {
+                const auto event = next_event.has_value() ? *next_event : getNextEvent();
+                game_finished = processEvent(event);
+            }
+            if (!game_finished && game_end_requested_.load(std::memory_order_acquire)) {
+                console_manager_->gameEndMessage();
+                game_finished = true;
             }
         }
         LOG_I("Game stopped, exiting UI loop");
         game_manager_->stopGame();
     }
 
-    void addNewEvent(UIEventType event) {
-        std::scoped_lock<std::mutex> lock(event_queue_mutex_);
-        if (event_queue_.size() < kMaxEventCount) {
-            event_queue_.push(event);
-            event_semaphore_.release(); // Notify that a new event is available
-        } else {
-            LOG_E("Event queue is full, dropping event");
+    // Returns true once the game has ended
+    bool processEvent(UIEventType event) {
+        TRACE_SPAN("ui", "handle_event");
+        switch (event) {
+            case UIEventType::PlayerMove: // Get player move
+                move_pending_ = true;
+                break;
+            case UIEventType::RoundEnd:  // Print game stats
+                console_manager_->printRoundEndMessage(getGameBoard(),
+                                                       last_round_result_,
+                                                       game_round_ - 1);    // Decrement round for display
+                break;
+            case UIEventType::GameEnd:
+                console_manager_->gameEndMessage(); // Print game end message
+                return true;
+            default:
+                LOG_E("Invalid event type: {}", static_cast<int>(event));
+                break;
         }
+        return false;
+    }
+
+    // Called from the game threads, blocks while the UI is behind instead of dropping events
+    void addNewEvent(UIEventType event) {
+        event_queue_.push(event);
+        console_manager_->wake();
     }
 
     UIEventType getNextEvent() {
-        event_semaphore_.acquire(); // Wait for an event to be available
-        std::scoped_lock<std::mutex> lock(event_queue_mutex_);
-        if (!event_queue_.empty()) {
-            auto event = event_queue_.front();
-            event_queue_.pop();
-            return event;
-        } else {
-            LOG_E("Event queue is empty, returning default event");
-            return UIEventType::kInvalidEvent; // Return default event if queue is empty
-        }
+        TRACE_SPAN("ui", "wait_event");
+        return event_queue_.pop(); // Wait for an event to be available
     }
 
     Board::BoardType getGameBoard() {
@@ -182,8 +212,9 @@ private:
     }
 };
 
-UserInterface::UserInterface():
-    impl_(std::make_unique<UserInterfaceImpl>()) {
+UserInterface::UserInterface(std::shared_ptr<Journal::IJournalWriter> journal,
+                             std::optional<GameEngine::Snapshot> resume):
+    impl_(std::make_unique<UserInterfaceImpl>(std::move(journal), std::move(resume))) {
 }
 
 } // namespace UI
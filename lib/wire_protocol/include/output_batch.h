@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Wire {
+
+// Immutable encoded frames shared between several peers, e.g. one board delta for all spectators
+using SharedFrames = std::shared_ptr<const std::vector<uint8_t>>;
+
+enum class FlushResult {
+    kDone,          // everything was written
+    kWouldBlock,    // the socket is full, call flush() again once it is writable
+    kError          // the peer is gone
+};
+
+// Outgoing bytes of one peer. Frames are encoded straight into an inline buffer and shared
+// frames are queued by reference, flush() hands all of them to a single sendmsg() (writev()
+// with MSG_NOSIGNAL).
+class OutputBatch {
+public:
+    OutputBatch();
+
+    // Space for a frame of the given size at the end of the inline buffer, valid until the next call
+    uint8_t *reserve(size_t size);
+    void appendShared(SharedFrames frames);
+
+    bool empty() const {
+        return segments_.empty();
+    }
+
+    size_t size() const;
+    FlushResult flush(int socket_fd);
+    void clear();
+    // Drops everything not yet started, a partially written frame is kept so the stream stays intact
+    void discardUnsent();
+
+private:
+    struct Segment {
+        SharedFrames shared;    // nullptr for a range of the inline buffer
+        size_t offset;
+        size_t size;
+        bool started = false;
+    };
+
+    std::vector<uint8_t> inline_;
+    std::deque<Segment> segments_;
+};
+
+} // namespace Wire
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "board.h"
+#include "game_result_type.h"
+#include "player_type.h"
+
+namespace Wire {
+
+// Frame layout, all integers little-endian:
+//   header:  type u8 | version u8 | payload size u16
+//   payload: fixed size per message type, see below
+// Messages are read in place through the *Message views, which only hold a pointer into the
+// receive buffer, so decoding never copies or allocates.
+constexpr uint8_t kVersion = 1U;
+constexpr size_t kHeaderSize = 4U;
+
+enum class MessageType : uint8_t {
+    Hello = 1,          // server -> player: player type u8, board size u8, reserved u16, move timeout ms u32, session u32
+    MoveRequest = 2,    // server -> player: compact board
+    Move = 3,           // player -> server: row u8, col u8
+    BoardDelta = 4,     // server -> spectator: row u8, col u8, player type u8, move number u8
+    RoundEnd = 5,       // server -> all: result u8, reserved u8[3], round u32
+    Score = 6,          // server -> all: host score u32, guest score u32
+    BoardState = 7,     // server -> all: compact board
+    Join = 8,           // client -> server: reserved u32, asks to be matched with another player
+    Watch = 9           // client -> server: session u32, subscribes to a running session as a spectator
+};
+
+// Board with 2 bits per cell, row major, Board::BoardField values
+constexpr size_t kCompactBoardSize = (Board::kBoardSize * Board::kBoardSize * 2U + 7U) / 8U;
+using CompactBoard = std::array<uint8_t, kCompactBoardSize>;
+
+constexpr size_t payloadSize(MessageType type) {
+    switch (type) {
+        case MessageType::Hello:
+            return 12U;
+        case MessageType::MoveRequest:
+        case MessageType::BoardState:
+            return kCompactBoardSize;
+        case MessageType::Move:
+            return 2U;
+        case MessageType::BoardDelta:
+            return 4U;
+        case MessageType::RoundEnd:
+        case MessageType::Score:
+            return 8U;
+        case MessageType::Join:
+        case MessageType::Watch:
+            return 4U;
+    }
+    return 0U;
+}
+
+constexpr size_t frameSize(MessageType type) {
+    return kHeaderSize + payloadSize(type);
+}
+
+constexpr size_t kMaxFrameSize = kHeaderSize + 12U;
+static_assert(kCompactBoardSize <= 12U, "Compact board must fit the largest payload");
+
+inline uint16_t loadU16(const uint8_t *in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8U));
+}
+
+inline uint32_t loadU32(const uint8_t *in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8U) |
+           (static_cast<uint32_t>(in[2]) << 16U) | (static_cast<uint32_t>(in[3]) << 24U);
+}
+
+inline void storeU16(uint8_t *out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8U);
+}
+
+inline void storeU32(uint8_t *out, uint32_t value) {
+    storeU16(out, static_cast<uint16_t>(value));
+    storeU16(out + 2, static_cast<uint16_t>(value >> 16U));
+}
+
+inline CompactBoard compactBoard(const Board::BoardType &board) {
+    CompactBoard compact {};
+    for (size_t cell = 0; cell < Board::kBoardSize * Board::kBoardSize; ++cell) {
+        const auto field = static_cast<uint8_t>(board[cell / Board::kBoardSize][cell % Board::kBoardSize]);
+        compact[cell / 4U] |= static_cast<uint8_t>(field << ((cell % 4U) * 2U));
+    }
+    return compact;
+}
+
+inline Board::BoardType expandBoard(const uint8_t *compact) {
+    Board::BoardType board {};
+    for (size_t cell = 0; cell < Board::kBoardSize * Board::kBoardSize; ++cell) {
+        const auto field = static_cast<uint8_t>((compact[cell / 4U] >> ((cell % 4U) * 2U)) & 0x03U);
+        board[cell / Board::kBoardSize][cell % Board::kBoardSize] = static_cast<Board::BoardField>(field);
+    }
+    return board;
+}
+
+// Frame located in a receive buffer
+struct FrameView {
+    MessageType type;
+    const uint8_t *payload;
+
+    size_t size() const {
+        return frameSize(type);
+    }
+};
+
+enum class ParseStatus {
+    kFrame,         // a whole frame is available
+    kIncomplete,    // wait for more bytes
+    kMalformed      // unknown type, version or size, the stream cannot be resynchronised
+};
+
+struct ParseResult {
+    ParseStatus status;
+    FrameView frame;
+};
+
+inline ParseResult parseFrame(std::span<const uint8_t> data) {
+    if (data.size() < kHeaderSize) {
+        return {ParseStatus::kIncomplete, {}};
+    }
+    const auto type = static_cast<MessageType>(data[0]);
+    const auto expected_size = payloadSize(type);
+    if (expected_size == 0U || data[1] != kVersion || loadU16(data.data() + 2) != expected_size) {
+        return {ParseStatus::kMalformed, {}};
+    }
+    if (data.size() < kHeaderSize + expected_size) {
+        return {ParseStatus::kIncomplete, {}};
+    }
+    return {ParseStatus::kFrame, FrameView{type, data.data() + kHeaderSize}};
+}
+
+// In place views over a parsed frame, valid while the receive buffer is not modified
+struct HelloMessage {
+    const uint8_t *payload;
+
+    BoardPlayerType player_type() const { return static_cast<BoardPlayerType>(payload[0]); }
+    uint8_t board_size() const { return payload[1]; }
+    uint32_t move_timeout_ms() const { return loadU32(payload + 4); }
+    uint32_t session() const { return loadU32(payload + 8); }
+};
+
+struct MoveRequestMessage {
+    const uint8_t *payload;
+
+    Board::BoardType board() const { return expandBoard(payload); }
+};
+
+struct MoveMessage {
+    const uint8_t *payload;
+
+    std::pair<int, int> move() const { return {payload[0], payload[1]}; }
+};
+
+struct BoardDeltaMessage {
+    const uint8_t *payload;
+
+    std::pair<int, int> move() const { return {payload[0], payload[1]}; }
+    BoardPlayerType player_type() const { return static_cast<BoardPlayerType>(payload[2]); }
+    uint8_t move_number() const { return payload[3]; }
+};
+
+struct RoundEndMessage {
+    const uint8_t *payload;
+
+    RoundResult result() const { return static_cast<RoundResult>(payload[0]); }
+    uint32_t round() const { return loadU32(payload + 4); }
+};
+
+struct ScoreMessage {
+    const uint8_t *payload;
+
+    std::pair<int, int> score() const {
+        return {static_cast<int>(loadU32(payload)), static_cast<int>(loadU32(payload + 4))};
+    }
+};
+
+struct BoardStateMessage {
+    const uint8_t *payload;
+
+    Board::BoardType board() const { return expandBoard(payload); }
+};
+
+struct WatchMessage {
+    const uint8_t *payload;
+
+    uint32_t session() const { return loadU32(payload); }
+};
+
+// Encoders write one whole frame, out must hold frameSize(type) bytes. They return the frame size.
+inline uint8_t *encodeHeader(uint8_t *out, MessageType type) {
+    out[0] = static_cast<uint8_t>(type);
+    out[1] = kVersion;
+    storeU16(out + 2, static_cast<uint16_t>(payloadSize(type)));
+    return out + kHeaderSize;
+}
+
+inline size_t encodeHello(uint8_t *out, BoardPlayerType player_type, uint32_t move_timeout_ms, uint32_t session) {
+    auto *payload = encodeHeader(out, MessageType::Hello);
+    payload[0] = static_cast<uint8_t>(player_type);
+    payload[1] = static_cast<uint8_t>(Board::kBoardSize);
+    storeU16(payload + 2, 0U);
+    storeU32(payload + 4, move_timeout_ms);
+    storeU32(payload + 8, session);
+    return frameSize(MessageType::Hello);
+}
+
+inline size_t encodeJoin(uint8_t *out) {
+    storeU32(encodeHeader(out, MessageType::Join), 0U);
+    return frameSize(MessageType::Join);
+}
+
+inline size_t encodeWatch(uint8_t *out, uint32_t session) {
+    storeU32(encodeHeader(out, MessageType::Watch), session);
+    return frameSize(MessageType::Watch);
+}
+
+inline size_t encodeBoard(uint8_t *out, MessageType type, const Board::BoardType &board) {
+    auto *payload = encodeHeader(out, type);
+    const auto compact = compactBoard(board);
+    for (size_t i = 0; i < kCompactBoardSize; ++i) {
+        payload[i] = compact[i];
+    }
+    return frameSize(type);
+}
+
+inline size_t encodeMoveRequest(uint8_t *out, const Board::BoardType &board) {
+    return encodeBoard(out, MessageType::MoveRequest, board);
+}
+
+inline size_t encodeBoardState(uint8_t *out, const Board::BoardType &board) {
+    return encodeBoard(out, MessageType::BoardState, board);
+}
+
+inline size_t encodeMove(uint8_t *out, std::pair<int, int> move) {
+    auto *payload = encodeHeader(out, MessageType::Move);
+    payload[0] = static_cast<uint8_t>(move.first);
+    payload[1] = static_cast<uint8_t>(move.second);
+    return frameSize(MessageType::Move);
+}
+
+inline size_t encodeBoardDelta(uint8_t *out, std::pair<int, int> move, BoardPlayerType player_type,
+                               uint8_t move_number) {
+    auto *payload = encodeHeader(out, MessageType::BoardDelta);
+    payload[0] = static_cast<uint8_t>(move.first);
+    payload[1] = static_cast<uint8_t>(move.second);
+    payload[2] = static_cast<uint8_t>(player_type);
+    payload[3] = move_number;
+    return frameSize(MessageType::BoardDelta);
+}
+
+inline size_t encodeRoundEnd(uint8_t *out, RoundResult result, uint32_t round) {
+    auto *payload = encodeHeader(out, MessageType::RoundEnd);
+    payload[0] = static_cast<uint8_t>(result);
+    payload[1] = 0U;
+    storeU16(payload + 2, 0U);
+    storeU32(payload + 4, round);
+    return frameSize(MessageType::RoundEnd);
+}
+
+inline size_t encodeScore(uint8_t *out, std::pair<int, int> score) {
+    auto *payload = encodeHeader(out, MessageType::Score);
+    storeU32(payload, static_cast<uint32_t>(score.first));
+    storeU32(payload + 4, static_cast<uint32_t>(score.second));
+    return frameSize(MessageType::Score);
+}
+
+} // namespace Wire
@@ -0,0 +1,106 @@
+#include "output_batch.h"
+#include "log.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace Wire
+{
+
+namespace {
+
+constexpr size_t kInlineReserve = 512U;
+constexpr size_t kMaxIoVectors = 64U;
+
+} // namespace
+
+OutputBatch::OutputBatch() {
+    inline_.reserve(kInlineReserve);
+}
+
+uint8_t *OutputBatch::reserve(size_t size) {
+    const auto offset = inline_.size();
+    inline_.resize(offset + size);
+    // Consecutive inline frames form one segment
+    if (!segments_.empty() && segments_.back().shared == nullptr &&
+        segments_.back().offset + segments_.back().size == offset) {
+        segments_.back().size += size;
+    } else {
+        segments_.push_back(Segment{nullptr, offset, size, false});
+    }
+    return inline_.data() + offset;
+}
+
+void OutputBatch::appendShared(SharedFrames frames) {
+    if (frames == nullptr || frames->empty()) {
+        return;
+    }
+    const auto size = frames->size();
+    segments_.push_back(Segment{std::move(frames), 0U, size, false});
+}
+
+size_t OutputBatch::size() const {
+    size_t total = 0;
+    for (const auto &segment : segments_) {
+        total += segment.size;
+    }
+    return total;
+}
+
+FlushResult OutputBatch::flush(int socket_fd) {
+    while (!segments_.empty()) {
+        std::array<iovec, kMaxIoVectors> vectors;
+        size_t count = 0;
+        for (auto it = segments_.begin(); it != segments_.end() && count < vectors.size(); ++it, ++count) {
+            const auto *base = it->shared != nullptr ? it->shared->data() : inline_.data();
+            vectors[count] = iovec{const_cast<uint8_t *>(base + it->offset), it->size};
+        }
+        msghdr message {};
+        message.msg_iov = vectors.data();
+        message.msg_iovlen = count;
+        auto written = sendmsg(socket_fd, &message, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return FlushResult::kWouldBlock;
+            }
+            LOG_D("Output flush failed: {}", std::strerror(errno));
+            return FlushResult::kError;
+        }
+        // Drop what was written, a partially written segment keeps its tail
+        auto remaining = static_cast<size_t>(written);
+        while (remaining > 0U) {
+            auto &front = segments_.front();
+            if (remaining < front.size) {
+                front.offset += remaining;
+                front.size -= remaining;
+                front.started = true;
+                break;
+            }
+            remaining -= front.size;
+            segments_.pop_front();
+        }
+    }
+    inline_.clear();
+    return FlushResult::kDone;
+}
+
+void OutputBatch::discardUnsent() {
+    if (!segments_.empty() && segments_.front().started) {
+        segments_.resize(1U);
+    } else {
+        clear();
+    }
+}
+
+void OutputBatch::clear() {
+    segments_.clear();
+    inline_.clear();
+}
+
+} // namespace Wire
@@ -1,14 +1,101 @@
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
 
+#include "headless_interface.h"
+#include "journal.h"
 #include "user_interface.h"
 #include "log.h"
+#include "metrics.h"
+#include "trace.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe [options]\n"
+              << "  -s <path>        play the host moves from a file, - reads stdin, no console\n"
+              << "  -r <count>       with -s, stop after this many rounds (default: when the moves run out)\n";
+}
+
+// Scripted game through the real PlayerHost and GameManager, prints key=value results
+int runHeadless(const std::string &moves_path, size_t max_rounds) {
+    std::ifstream moves_file;
+    if (moves_path != "-") {
+        moves_file.open(moves_path);
+        if (!moves_file) {
+            std::cerr << "Cannot open " << moves_path << "\n";
+            return 1;
+        }
+    }
+    UI::HeadlessUserInterface user_interface({
+        .moves = moves_path == "-" ? &std::cin : &moves_file,
+        .output = stdout,
+        .max_rounds = max_rounds
+    });
+    user_interface.startGame();
+    return user_interface.result().input_error ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv){
+    std::optional<std::string> moves_path;
+    size_t max_rounds = 0;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-s") {
+                moves_path = value;
+            } else if (option == "-r") {
+                max_rounds = std::stoull(value);
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
 
-int main(int, char**){
-    std::cout << "Hello, from tictactoe!\n";
     // Initialize logger
     init_logger();
+    // Chrome trace of the engine, bot and UI spans written at exit, enabled by TICTACTOE_TRACE=<path>
+    if (const char *trace_path = std::getenv("TICTACTOE_TRACE")) {
+        Trace::start(trace_path);
+    }
+    if (moves_path.has_value()) {
+        return runHeadless(*moves_path, max_rounds);
+    }
+    std::cout << "Hello, from tictactoe!\n";
+
+    // Prometheus text dump on a Unix socket, enabled by TICTACTOE_METRICS_SOCKET=<path>
+    std::optional<Metrics::MetricsServer> metrics_server;
+    if (const char *metrics_socket = std::getenv("TICTACTOE_METRICS_SOCKET")) {
+        metrics_server.emplace(metrics_socket);
+    }
+
+    // Crash safe game journal, enabled by TICTACTOE_JOURNAL=<path>. A game interrupted by a crash
+    // is resumed from it on the next start.
+    std::shared_ptr<Journal::JournalWriter> journal;
+    std::optional<GameEngine::Snapshot> resume;
+    if (const char *journal_path = std::getenv("TICTACTOE_JOURNAL")) {
+        auto recovered = Journal::recoverJournal(journal_path);
+        if (!recovered.sessions.empty()) {
+            resume = recovered.sessions.front().snapshot;
+        }
+        journal = std::make_shared<Journal::JournalWriter>(journal_path);
+    }
 
-    UI::UserInterface user_interface;
+    UI::UserInterface user_interface(journal, resume);
     user_interface.startGame();
 
 
@@ -0,0 +1,181 @@
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "game_engine.h"
+#include "journal.h"
+#include "log.h"
+#include "player_bot.h"
+#include "player_manager.h"
+
+// Recovery checks for the session journal.
+// torn_tail: two sessions are journaled, the first one ends normally, the second one is still
+// running when the journal is copied, and the copy loses a few bytes of its last record like a
+// crash in the middle of a write. Recovery must report only the second session, at the state
+// before the torn record.
+// lost_round_end: a round is played to its end and the journal loses the RoundEnd record
+// behind the final move, like a crash after a commit which split the two. Recovery must still
+// report the round as finished, with the same score as the engine.
+
+namespace {
+
+constexpr uint32_t kClosedSession = 1U;
+constexpr uint32_t kOpenSession = 2U;
+constexpr size_t kTornBytes = 3U;
+constexpr size_t kRoundEndRecordSize = Journal::kRecordHeaderSize + 16U;
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_journal_recovery -d <directory>\n"
+              << "  -d <directory>   directory for the journal files\n";
+}
+
+std::unique_ptr<GameEngine::GameEngine> makeEngine(Random::Seed seed) {
+    auto player_manager = std::make_shared<PlayerManager::PlayerManager>(
+        PlayerManager::TypeOfGuestPlayer::Bot,
+        std::make_shared<Player::PlayerBot>(BoardPlayerType::X, std::make_unique<BotFactoryRandom>(), seed),
+        std::make_shared<Player::PlayerBot>(BoardPlayerType::O, std::make_unique<BotFactoryRandom>(), seed + 1U));
+    return std::make_unique<GameEngine::GameEngine>(player_manager, Board::kBoardSize);
+}
+
+void journal(GameEngine::GameEngine &engine, const std::shared_ptr<Journal::JournalWriter> &writer, uint32_t session) {
+    engine.addEventListener(std::make_shared<Journal::SessionJournal>(writer, session, engine.snapshot()));
+}
+
+// A whole round and the reset after it, so every record type is replayed
+void playRound(GameEngine::GameEngine &engine) {
+    while (engine.processGame({}) != GameEngine::GameEngineError::kGameFinished) {
+    }
+    engine.resetGame();
+}
+
+// Moves which cannot end the round, it needs five moves to be won
+void playMoves(GameEngine::GameEngine &engine, size_t moves) {
+    for (size_t move = 0; move < moves; ++move) {
+        engine.processGame({});
+    }
+}
+
+std::string checkTornTail(const std::filesystem::path &directory) {
+    const auto journal_path = (directory / "journal_recovery.journal").string();
+    const auto crashed_path = (directory / "journal_recovery_crashed.journal").string();
+
+    auto writer = std::make_shared<Journal::JournalWriter>(journal_path, Journal::JournalConfig{.truncate = true});
+
+    auto closed_engine = makeEngine(11U);
+    journal(*closed_engine, writer, kClosedSession);
+    auto open_engine = makeEngine(21U);
+    journal(*open_engine, writer, kOpenSession);
+
+    playRound(*closed_engine);
+    playRound(*open_engine);
+    playMoves(*open_engine, 2U);
+    // Destroying the engine destroys its SessionJournal, which records the normal end
+    closed_engine.reset();
+
+    writer->sync();
+    const auto expected = open_engine->snapshot();
+    const auto intact_size = std::filesystem::file_size(journal_path);
+
+    // The record torn below
+    playMoves(*open_engine, 1U);
+    writer->sync();
+    const auto full_size = std::filesystem::file_size(journal_path);
+
+    std::filesystem::copy_file(journal_path, crashed_path, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::resize_file(crashed_path, full_size - kTornBytes);
+
+    const auto result = Journal::recoverJournal(crashed_path);
+    std::printf("check=torn_tail records=%zu sessions=%zu torn_tail=%d intact_bytes=%ju torn_bytes=%ju\n",
+                result.records, result.sessions.size(), result.torn_tail ? 1 : 0, static_cast<uintmax_t>(intact_size),
+                static_cast<uintmax_t>(full_size - intact_size));
+
+    std::string status = "ok";
+    if (full_size <= intact_size || full_size - intact_size <= kTornBytes) {
+        status = "no_record_to_tear";
+    } else if (!result.torn_tail) {
+        status = "torn_tail_not_detected";
+    } else if (result.sessions.size() != 1U || result.sessions.front().session != kOpenSession) {
+        status = "wrong_sessions";
+    } else if (result.sessions.front().snapshot != expected) {
+        status = "snapshot_mismatch";
+    }
+
+    open_engine.reset();
+    std::filesystem::remove(journal_path);
+    std::filesystem::remove(crashed_path);
+    return status;
+}
+
+std::string checkLostRoundEnd(const std::filesystem::path &directory) {
+    const auto journal_path = (directory / "journal_recovery_round_end.journal").string();
+    const auto crashed_path = (directory / "journal_recovery_round_end_crashed.journal").string();
+
+    auto writer = std::make_shared<Journal::JournalWriter>(journal_path, Journal::JournalConfig{.truncate = true});
+    auto engine = makeEngine(31U);
+    journal(*engine, writer, kOpenSession);
+
+    // Leaves the round finished, the journal ends with the final Move and its RoundEnd
+    while (engine->processGame({}) != GameEngine::GameEngineError::kGameFinished) {
+    }
+    writer->sync();
+    const auto expected = engine->snapshot();
+    const auto full_size = std::filesystem::file_size(journal_path);
+
+    std::filesystem::copy_file(journal_path, crashed_path, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::resize_file(crashed_path, full_size - kRoundEndRecordSize);
+
+    const auto result = Journal::recoverJournal(crashed_path);
+    std::printf("check=lost_round_end records=%zu sessions=%zu torn_tail=%d\n", result.records,
+                result.sessions.size(), result.torn_tail ? 1 : 0);
+
+    std::string status = "ok";
+    if (result.torn_tail) {
+        status = "round_end_not_cut_cleanly";
+    } else if (result.sessions.size() != 1U || result.sessions.front().session != kOpenSession) {
+        status = "wrong_sessions";
+    } else if (result.sessions.front().snapshot != expected) {
+        status = "snapshot_mismatch";
+    }
+
+    engine.reset();
+    std::filesystem::remove(journal_path);
+    std::filesystem::remove(crashed_path);
+    return status;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger(Log::Mode::Sync);
+
+    std::filesystem::path directory;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view option = argv[i];
+        if (option == "-d" && i + 1 < argc) {
+            directory = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (directory.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        size_t failures = 0;
+        for (const auto &check : {checkTornTail, checkLostRoundEnd}) {
+            const auto status = check(directory);
+            std::printf("status=%s\n", status.c_str());
+            failures += status == "ok" ? 0U : 1U;
+        }
+        return failures == 0U ? 0 : 1;
+    } catch (const std::exception &e) {
+        std::cerr << "Journal recovery check failed: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench.h"
+#include "board.h"
+#include "bot_algorithm.h"
+#include "log.h"
+
+// Regression gate for the bot search. Node counts and chosen moves must match the baseline
+// exactly, allocations must not grow and the search time, relative to a fixed calibration
+// loop on the same machine, must stay within the threshold of the baseline.
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_perf_gate -b <baseline> [options]\n"
+              << "  -b <path>        baseline file\n"
+              << "  -w               write the measured values as the new baseline instead of checking\n"
+              << "  -r <fraction>    allowed relative time regression (default 0.3)\n"
+              << "  -n <count>       timing repetitions, the fastest counts (default 5)\n";
+}
+
+struct Position {
+    std::string_view cells;     // rows top to bottom, '.' is empty
+    BoardPlayerType bot;
+    // Answered without a search in a fraction of a calibration loop, timer noise exceeds any
+    // useful threshold, so only the move, node count and allocations are checked
+    bool untimed = false;
+};
+
+constexpr std::array<Position, 6> kPositions = {{
+    {"X........", BoardPlayerType::O},
+    {"....X....", BoardPlayerType::O},
+    {"X...O...X", BoardPlayerType::O},
+    {"XO.......", BoardPlayerType::X},
+    {"XX..O....", BoardPlayerType::O, true},  // must block, no search
+    {"XX.OO.X..", BoardPlayerType::O, true},  // can win, no search
+}};
+
+constexpr std::chrono::milliseconds kMinTime {50};
+// Machine load can slow the search for seconds at a time. The baseline is the median of this many
+// passes, and a position over its budget is measured up to this many times: a real regression
+// stays over it in every attempt.
+constexpr size_t kTimeAttempts = 5;
+
+struct Measurement {
+    std::string move;
+    size_t nodes = 0;
+    uint64_t allocations = 0;
+    double relative_time = 0.0;
+};
+
+using Record = std::map<std::string, std::string, std::less<>>;
+
+Board::BoardType parseBoard(std::string_view cells) {
+    Board::BoardType board {};
+    for (size_t index = 0; index < cells.size(); ++index) {
+        auto &field = board[index / Board::kBoardSize][index % Board::kBoardSize];
+        field = cells[index] == 'X' ? Board::BoardField::X
+                : cells[index] == 'O' ? Board::BoardField::O
+                : Board::BoardField::EMPTY;
+    }
+    return board;
+}
+
+// Fixed work independent of the code under test, times are expressed in units of it
+double calibrationNs() {
+    return Bench::run("calibration", 1U, kMinTime, [] {
+        std::array<uint32_t, 1024> table {};
+        uint32_t state = 2463534242U;
+        for (size_t step = 0; step < 4096U; ++step) {
+            state ^= state << 13U;
+            state ^= state >> 17U;
+            state ^= state << 5U;
+            table[state % table.size()] += state;
+        }
+        Bench::doNotOptimize(table);
+    }).ns_per_op;
+}
+
+Measurement measure(const Position &position, size_t repetitions) {
+    BotAlgorithm algorithm;
+    const auto board = parseBoard(position.cells);
+    Measurement measurement;
+
+    const auto allocations_before = Bench::allocationCounts();
+    const auto move = algorithm.getMove(Board::BoardView(board), position.bot, {});
+    measurement.allocations = Bench::allocationCounts().allocations - allocations_before.allocations;
+    measurement.nodes = algorithm.lastSearchNodeCount();
+    measurement.move = std::to_string(move.first) + "," + std::to_string(move.second);
+
+    // The calibration runs next to every repetition, so both fastest times come from the same
+    // stretch of machine load instead of the calibration alone catching a noisy moment
+    double fastest = 0.0;
+    double fastest_calibration = 0.0;
+    for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+        const auto calibration_ns = calibrationNs();
+        const auto result = Bench::run(std::string(position.cells), 1U, kMinTime, [&] {
+            Bench::doNotOptimize(algorithm.getMove(Board::BoardView(board), position.bot, {}));
+        });
+        fastest = repetition == 0U ? result.ns_per_op : std::min(fastest, result.ns_per_op);
+        fastest_calibration = repetition == 0U ? calibration_ns : std::min(fastest_calibration, calibration_ns);
+    }
+    measurement.relative_time = fastest / fastest_calibration;
+    return measurement;
+}
+
+// key=value tokens per line, '#' starts a comment
+std::vector<Record> readBaseline(const std::string &path) {
+    std::vector<Record> records;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(std::min(line.find('#'), line.size()));
+        std::istringstream tokens(line);
+        Record record;
+        std::string token;
+        while (tokens >> token) {
+            const auto equals = token.find('=');
+            if (equals != std::string::npos) {
+                record[token.substr(0, equals)] = token.substr(equals + 1U);
+            }
+        }
+        if (!record.empty()) {
+            records.push_back(std::move(record));
+        }
+    }
+    return records;
+}
+
+std::string botName(BoardPlayerType bot) {
+    return bot == BoardPlayerType::X ? "X" : "O";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger(Log::Mode::Sync);
+
+    std::string baseline_path;
+    bool write_baseline = false;
+    double threshold = 0.3;
+    size_t repetitions = 5;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (option == "-w") {
+                write_baseline = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-b") {
+                baseline_path = value;
+            } else if (option == "-r") {
+                threshold = std::stod(value);
+            } else if (option == "-n") {
+                repetitions = std::max<size_t>(1U, std::stoull(value));
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+    if (baseline_path.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<Measurement> measurements;
+    for (const auto &position : kPositions) {
+        measurements.push_back(measure(position, repetitions));
+    }
+
+    if (write_baseline) {
+        std::vector<std::vector<double>> relative_times(kPositions.size());
+        for (size_t pass = 0; pass < kTimeAttempts; ++pass) {
+            for (size_t index = 0; index < kPositions.size(); ++index) {
+                relative_times[index].push_back(pass == 0U ? measurements[index].relative_time
+                                                           : measure(kPositions[index], repetitions).relative_time);
+            }
+        }
+        for (size_t index = 0; index < kPositions.size(); ++index) {
+            auto &times = relative_times[index];
+            std::nth_element(times.begin(), times.begin() + static_cast<std::ptrdiff_t>(times.size() / 2U), times.end());
+            measurements[index].relative_time = times[times.size() / 2U];
+        }
+
+        std::ofstream file(baseline_path);
+        file << "# tictactoe_perf_gate baseline, rewrite with -w after an intended change\n"
+             << "# relative_time is the search time in units of the calibration loop\n"
+             << "build_type=" << TICTACTOE_BUILD_TYPE << "\n";
+        for (size_t index = 0; index < kPositions.size(); ++index) {
+            const auto &measurement = measurements[index];
+            char relative_time[32];
+            std::snprintf(relative_time, sizeof(relative_time), "%.3f", measurement.relative_time);
+            file << "position=" << kPositions[index].cells << " bot=" << botName(kPositions[index].bot)
+                 << " move=" << measurement.move << " nodes=" << measurement.nodes
+                 << " allocs=" << measurement.allocations << " relative_time=" << relative_time << "\n";
+        }
+        if (!file) {
+            std::cerr << "Cannot write " << baseline_path << "\n";
+            return 1;
+        }
+        std::printf("baseline=%s positions=%zu\n", baseline_path.c_str(), kPositions.size());
+        return 0;
+    }
+
+    const auto baseline = readBaseline(baseline_path);
+    if (baseline.empty()) {
+        std::cerr << "Cannot read baseline " << baseline_path << "\n";
+        return 1;
+    }
+    // Time ratios differ between optimization levels, only compare like with like
+    const auto baseline_build = baseline.front().contains("build_type") ? baseline.front().at("build_type") : "";
+    const bool check_time = baseline_build == TICTACTOE_BUILD_TYPE;
+    std::printf("build_type=%s baseline_build_type=%s time_check=%s threshold=%.2f\n", TICTACTOE_BUILD_TYPE,
+                baseline_build.c_str(), check_time ? "on" : "skipped", threshold);
+
+    size_t failures = 0;
+    for (size_t index = 0; index < kPositions.size(); ++index) {
+        const auto &position = kPositions[index];
+        auto &measurement = measurements[index];
+        const Record *expected = nullptr;
+        for (const auto &record : baseline) {
+            if (record.contains("position") && record.at("position") == position.cells &&
+                record.contains("bot") && record.at("bot") == botName(position.bot)) {
+                expected = &record;
+            }
+        }
+
+        std::string status = "ok";
+        double budget = 0.0;
+        if (expected == nullptr) {
+            status = "missing_from_baseline";
+        } else {
+            budget = std::stod(expected->at("relative_time")) * (1.0 + threshold);
+            const bool timed = check_time && !position.untimed;
+            for (size_t attempt = 1; timed && attempt < kTimeAttempts && measurement.relative_time > budget; ++attempt) {
+                measurement.relative_time = std::min(measurement.relative_time,
+                                                     measure(position, repetitions).relative_time);
+            }
+            if (expected->at("move") != measurement.move) {
+                status = "move_changed";
+            } else if (std::stoull(expected->at("nodes")) != measurement.nodes) {
+                status = "node_count_changed";
+            } else if (measurement.allocations > std::stoull(expected->at("allocs"))) {
+                status = "allocations_regressed";
+            } else if (timed && measurement.relative_time > budget) {
+                status = "time_regressed";
+            }
+        }
+        if (status != "ok") {
+            ++failures;
+        }
+        std::printf("position=%.*s bot=%s move=%s nodes=%zu allocs=%llu relative_time=%.3f budget=%.3f time_check=%s status=%s\n",
+                    static_cast<int>(position.cells.size()), position.cells.data(), botName(position.bot).c_str(),
+                    measurement.move.c_str(), measurement.nodes, static_cast<unsigned long long>(measurement.allocations),
+                    measurement.relative_time, budget, !check_time ? "skipped" : position.untimed ? "untimed" : "on",
+                    status.c_str());
+    }
+    std::printf("perf_gate=%s failures=%zu\n", failures == 0U ? "pass" : "fail", failures);
+    return failures == 0U ? 0 : 1;
+}
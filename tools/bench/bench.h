@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+// Minimal benchmark harness: repeats a body until it ran for the minimum time and reports the
+// last batch. Allocations are counted by the operator new replacement in alloc_counter.cpp.
+namespace Bench {
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Totals of all threads since the start of the process
+AllocationCounts allocationCounts();
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;
+    uint64_t ops_per_iteration = 1;     // e.g. moves made by one iteration
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+    double bytes_per_op = 0.0;
+    double ops_per_second = 0.0;
+};
+
+// Keeps the compiler from dropping a computation whose result is unused
+template <typename T>
+inline void doNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename Body>
+Result run(std::string name, uint64_t ops_per_iteration, std::chrono::nanoseconds min_time, Body &&body) {
+    using Clock = std::chrono::steady_clock;
+    uint64_t iterations = 1;
+    while (true) {
+        const auto allocations_before = allocationCounts();
+        const auto start = Clock::now();
+        for (uint64_t iteration = 0; iteration < iterations; ++iteration) {
+            body();
+        }
+        const auto elapsed = Clock::now() - start;
+        const auto allocations_after = allocationCounts();
+        if (elapsed >= min_time || iterations >= (uint64_t {1} << 40U)) {
+            const auto ops = static_cast<double>(iterations * ops_per_iteration);
+            const auto nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            return Result {
+                .name = std::move(name),
+                .iterations = iterations,
+                .ops_per_iteration = ops_per_iteration,
+                .ns_per_op = nanoseconds / ops,
+                .allocs_per_op = static_cast<double>(allocations_after.allocations - allocations_before.allocations) / ops,
+                .bytes_per_op = static_cast<double>(allocations_after.bytes - allocations_before.bytes) / ops,
+                .ops_per_second = nanoseconds > 0.0 ? ops * 1e9 / nanoseconds : 0.0,
+            };
+        }
+        // Aim a bit past the minimum time with the next batch
+        const auto ratio = static_cast<double>(min_time.count()) /
+                           std::max(1.0, static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        iterations = std::max(iterations * 2U, static_cast<uint64_t>(static_cast<double>(iterations) * ratio * 1.2));
+    }
+}
+
+inline void print(const Result &result) {
+    std::printf("benchmark=%s iterations=%llu ns_per_op=%.1f allocs_per_op=%.2f bytes_per_op=%.1f ops_per_second=%.0f\n",
+                result.name.c_str(), static_cast<unsigned long long>(result.iterations), result.ns_per_op,
+                result.allocs_per_op, result.bytes_per_op, result.ops_per_second);
+    std::fflush(stdout);
+}
+
+} // namespace Bench
@@ -0,0 +1,200 @@
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench.h"
+#include "board.h"
+#include "bot_algorithm.h"
+#include "bot_evaluator.h"
+#include "bot_random.h"
+#include "evaluator.h"
+#include "game_engine.h"
+#include "log.h"
+#include "player_bot.h"
+#include "player_manager.h"
+
+#ifndef TICTACTOE_BUILD_TYPE
+#define TICTACTOE_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_bench [options]\n"
+              << "  -f <text>        run only benchmarks whose name contains the text\n"
+              << "  -t <ms>          minimum run time per benchmark (default 200)\n";
+}
+
+// Rows top to bottom, '.' is empty
+Board::BoardType parseBoard(std::string_view cells) {
+    Board::BoardType board {};
+    for (size_t index = 0; index < cells.size(); ++index) {
+        auto &field = board[index / Board::kBoardSize][index % Board::kBoardSize];
+        field = cells[index] == 'X' ? Board::BoardField::X
+                : cells[index] == 'O' ? Board::BoardField::O
+                : Board::BoardField::EMPTY;
+    }
+    return board;
+}
+
+// Bot positions, O to move in all of them
+constexpr std::array<std::string_view, 4> kPositions = {
+    "X........",    // opening reply, the deepest search
+    "X...O...X",    // quiet middle game
+    "XX..O....",    // must block
+    "XX.OO.X..",    // can win
+};
+
+// A whole round without blocking moves, both players drawn from the same kind of bot
+constexpr std::array<std::pair<int, int>, 9> kMoveSequence = {{
+    {1, 1}, {0, 0}, {0, 2}, {2, 0}, {1, 0}, {1, 2}, {0, 1}, {2, 1}, {2, 2}
+}};
+
+std::shared_ptr<PlayerManager::PlayerManager> makeBotPlayers(std::unique_ptr<IBotFactory> host,
+                                                             std::unique_ptr<IBotFactory> guest) {
+    return std::make_shared<PlayerManager::PlayerManager>(
+        PlayerManager::TypeOfGuestPlayer::Bot,
+        std::make_shared<Player::PlayerBot>(BoardPlayerType::X, std::move(host), 1U),
+        std::make_shared<Player::PlayerBot>(BoardPlayerType::O, std::move(guest), 2U));
+}
+
+// Processes moves until the round ends, one iteration is one round
+uint64_t playRound(GameEngine::GameEngine &engine) {
+    uint64_t moves = 0;
+    while (engine.processGame({}) != GameEngine::GameEngineError::kGameFinished) {
+        ++moves;
+    }
+    engine.resetGame();
+    return moves + 1U;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger(Log::Mode::Sync);
+
+    std::string filter;
+    std::chrono::milliseconds min_time {200};
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-f") {
+                filter = value;
+            } else if (option == "-t") {
+                min_time = std::chrono::milliseconds(std::stoull(value));
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::printf("build_type=%s min_time_ms=%lld\n", TICTACTOE_BUILD_TYPE, static_cast<long long>(min_time.count()));
+    auto bench = [&](std::string name, uint64_t ops_per_iteration, auto &&body) {
+        if (name.find(filter) != std::string::npos) {
+            Bench::print(Bench::run(std::move(name), ops_per_iteration, min_time, body));
+        }
+    };
+
+    // Board
+    bench("board_make_move", kMoveSequence.size(), [] {
+        Board::Board board;
+        for (size_t index = 0; index < kMoveSequence.size(); ++index) {
+            const auto [row, col] = kMoveSequence[index];
+            const auto player = index % 2U == 0U ? BoardPlayerType::X : BoardPlayerType::O;
+            Bench::doNotOptimize(board.make_move(row, col, player));
+        }
+    });
+    {
+        const Board::Board board {parseBoard("XOXOOXXXO")};
+        bench("board_is_winner", 1U, [&] {
+            Bench::doNotOptimize(board.is_winner(BoardPlayerType::X));
+        });
+        bench("board_is_full", 1U, [&] {
+            Bench::doNotOptimize(board.is_full());
+        });
+    }
+    {
+        const auto cells = parseBoard("XO..X..O.");
+        const Board::Board board {cells};
+        bench("board_copy_state", 1U, [&] {
+            auto copy = board.get_board();
+            Bench::doNotOptimize(copy);
+        });
+        // What the bot search does for every node
+        bench("board_construct", 1U, [&] {
+            Board::Board copy {cells};
+            Bench::doNotOptimize(copy);
+        });
+    }
+
+    // Bots on the fixed positions, one op is one move
+    {
+        BotRandom bot {7U};
+        std::vector<Board::BoardType> boards;
+        for (const auto position : kPositions) {
+            boards.push_back(parseBoard(position));
+        }
+        bench("bot_random_get_move", boards.size(), [&] {
+            for (const auto &board : boards) {
+                Bench::doNotOptimize(bot.getMove(Board::BoardView(board), BoardPlayerType::O, {}));
+            }
+        });
+        BotAlgorithm algorithm;
+        for (size_t index = 0; index < kPositions.size(); ++index) {
+            bench("bot_algorithm_get_move_p" + std::to_string(index), 1U, [&] {
+                Bench::doNotOptimize(algorithm.getMove(Board::BoardView(boards[index]), BoardPlayerType::O, {}));
+            });
+        }
+        BotEvaluator evaluator_bot {Eval::Network::builtIn(), BotEvaluator::kDefaultDepth};
+        for (size_t index = 0; index < kPositions.size(); ++index) {
+            bench("bot_evaluator_get_move_p" + std::to_string(index), 1U, [&] {
+                Bench::doNotOptimize(evaluator_bot.getMove(Board::BoardView(boards[index]), BoardPlayerType::O, {}));
+            });
+        }
+    }
+
+    // Evaluator, one op is one make/unmake pair or one evaluation
+    {
+        Eval::NetworkEvaluator evaluator {Eval::Network::builtIn()};
+        evaluator.reset(parseBoard("X...O...X"));
+        std::printf("evaluator_kernels=%s\n", Eval::kernelName());
+        bench("evaluator_make_unmake", 1U, [&] {
+            evaluator.make(0, 1, Board::BoardField::O);
+            evaluator.unmake(0, 1, Board::BoardField::O);
+        });
+        bench("evaluator_evaluate", 1U, [&] {
+            Bench::doNotOptimize(evaluator.evaluate());
+        });
+    }
+
+    // Engine, one op is one round played through processGame()
+    {
+        GameEngine::GameEngine engine(makeBotPlayers(std::make_unique<BotFactoryRandom>(),
+                                                     std::make_unique<BotFactoryRandom>()), Board::kBoardSize);
+        bench("engine_round_random", 1U, [&] {
+            Bench::doNotOptimize(playRound(engine));
+        });
+    }
+    {
+        GameEngine::GameEngine engine(makeBotPlayers(std::make_unique<BotFactoryRandom>(),
+                                                     std::make_unique<BotFactoryAlgorithm>()), Board::kBoardSize);
+        bench("engine_round_random_vs_algorithm", 1U, [&] {
+            Bench::doNotOptimize(playRound(engine));
+        });
+    }
+    return 0;
+}
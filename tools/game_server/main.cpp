@@ -0,0 +1,89 @@
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "game_server.h"
+#include "log.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_server [options]\n"
+              << "  -a <address>     listen IPv4 address (default 0.0.0.0)\n"
+              << "  -p <port>        listen port (default 7777)\n"
+              << "  -t <count>       event loop shards (default 1)\n"
+              << "  -c <count>       max connections per shard (default 4096)\n"
+              << "  -m <ms>          move timeout in milliseconds (default 30000)\n"
+              << "  -j <path>        write-ahead journal of all sessions\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger();
+
+    GameServer::GameServerConfig config;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-a") {
+                config.address = value;
+            } else if (option == "-p") {
+                config.port = static_cast<uint16_t>(std::stoul(value));
+            } else if (option == "-t") {
+                config.shards = std::stoull(value);
+            } else if (option == "-c") {
+                config.max_connections_per_shard = std::stoull(value);
+            } else if (option == "-m") {
+                config.move_timeout = std::chrono::milliseconds(std::stoull(value));
+            } else if (option == "-j") {
+                config.journal_path = value;
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Handled by sigwait() below, blocked before the shard threads inherit the mask
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        GameServer::GameServer server(std::move(config));
+        server.start();
+        std::printf("port=%u\n", static_cast<unsigned>(server.port()));
+        std::fflush(stdout);
+
+        int signal = 0;
+        sigwait(&signals, &signal);
+        server.stop();
+
+        const auto stats = server.stats();
+        std::printf("connections_accepted=%zu connections_rejected=%zu sessions_started=%zu sessions_finished=%zu "
+                    "spectators_attached=%zu\n",
+                    stats.connections_accepted, stats.connections_rejected, stats.sessions_started,
+                    stats.sessions_finished, stats.spectators_attached);
+        std::printf("journal_records=%zu journal_commits=%zu journal_failed=%d journal_dropped=%zu\n",
+                    stats.journal_records, stats.journal_commits, stats.journal_failed ? 1 : 0,
+                    stats.journal_dropped);
+    } catch (const std::exception &e) {
+        LOG_E("Game server failed: {}", e.what());
+        std::cerr << "Game server failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
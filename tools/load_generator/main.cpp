@@ -0,0 +1,383 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "board.h"
+#include "histogram.h"
+#include "log.h"
+#include "random.h"
+#include "remote_socket.h"
+#include "wire_protocol.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_loadgen -p <port> [options]\n"
+              << "  -a <address>     server IPv4 address (default 127.0.0.1)\n"
+              << "  -p <port>        server port\n"
+              << "  -c <count>       simulated players (default 1000)\n"
+              << "  -t <count>       client threads, each with its own epoll loop (default 1)\n"
+              << "  -d <seconds>     test duration (default 10)\n"
+              << "  -k <ms>          think time before every move (default 0)\n"
+              << "  -j <ms>          random extra think time, uniform in [0, ms] (default 0)\n"
+              << "  -s <seed>        move and think time seed (default 0)\n";
+}
+
+struct LoadConfig {
+    std::string address = "127.0.0.1";
+    uint16_t port = 0;
+    size_t connections = 1000;
+    size_t threads = 1;
+    std::chrono::seconds duration{10};
+    std::chrono::milliseconds think_time{0};
+    std::chrono::milliseconds think_jitter{0};
+    Random::Seed seed = 0;
+};
+
+struct LoadStats {
+    size_t connected = 0;
+    size_t connect_failures = 0;
+    size_t disconnects = 0;
+    size_t moves = 0;
+    size_t rounds = 0;
+};
+
+struct SimulatedPlayer {
+    int fd = -1;
+    BoardPlayerType player_type = BoardPlayerType::O;
+    std::array<uint8_t, Wire::kMaxFrameSize * 16U> input {};
+    size_t input_size = 0;
+    std::pair<int, int> next_move = Board::kInvalidMove;
+    // Set while a move is on its way, cleared by the next frame from the server
+    std::optional<Clock::time_point> move_sent;
+};
+
+// Share of the simulated players driven by one thread. Move round trip is measured from sending a
+// move to the next MoveRequest or RoundEnd for the same player, so it spans the opponent's turn,
+// opponent think time included. With -k 0 it is the bare server and network path.
+class LoadWorker {
+public:
+    LoadWorker(const LoadConfig &config, size_t connections, Random::Seed seed) :
+            config_(config), connections_(connections), gen_(seed) {}
+
+    void run(Clock::time_point end) {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            LOG_E("epoll_create1 failed: {}", std::strerror(errno));
+            return;
+        }
+        connect();
+        std::array<epoll_event, 256> events;
+        while (true) {
+            const auto now = Clock::now();
+            if (now >= end) {
+                break;
+            }
+            sendDueMoves(now);
+            auto wait_until = end;
+            if (!timers_.empty()) {
+                wait_until = std::min(wait_until, timers_.top().first);
+            }
+            const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(wait_until - Clock::now());
+            const auto count = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()),
+                                          static_cast<int>(std::max<int64_t>(timeout.count(), 0)));
+            if (count < 0 && errno != EINTR) {
+                LOG_E("epoll_wait failed: {}", std::strerror(errno));
+                break;
+            }
+            for (int i = 0; i < count; ++i) {
+                onReadable(static_cast<uint32_t>(events[i].data.u32));
+            }
+        }
+        for (auto &player : players_) {
+            if (player.fd >= 0) {
+                close(player.fd);
+            }
+        }
+        close(epoll_fd_);
+    }
+
+    const LoadStats &stats() const {
+        return stats_;
+    }
+
+    const Metrics::Histogram &rtt() const {
+        return rtt_;
+    }
+
+private:
+    using Timer = std::pair<Clock::time_point, uint32_t>;
+
+    const LoadConfig &config_;
+    size_t connections_;
+    Random::Xoshiro256pp gen_;
+    int epoll_fd_ = -1;
+    std::vector<SimulatedPlayer> players_;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers_;
+    LoadStats stats_;
+    Metrics::Histogram rtt_;
+
+    void connect() {
+        players_.resize(connections_);
+        std::array<uint8_t, Wire::frameSize(Wire::MessageType::Join)> join {};
+        Wire::encodeJoin(join.data());
+        for (uint32_t index = 0; index < players_.size(); ++index) {
+            auto &player = players_[index];
+            try {
+                player.fd = Remote::connectTcp(config_.address, config_.port);
+            } catch (const std::exception &) {
+                ++stats_.connect_failures;
+                continue;
+            }
+            // The Join frame is tiny, a fresh socket always has room for it
+            if (send(player.fd, join.data(), join.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(join.size())) {
+                ++stats_.connect_failures;
+                disconnect(player);
+                continue;
+            }
+            fcntl(player.fd, F_SETFL, fcntl(player.fd, F_GETFL) | O_NONBLOCK);
+            epoll_event event {.events = EPOLLIN | EPOLLRDHUP, .data = {.u32 = index}};
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, player.fd, &event);
+            ++stats_.connected;
+        }
+    }
+
+    void disconnect(SimulatedPlayer &player) {
+        close(player.fd);
+        player.fd = -1;
+    }
+
+    void onReadable(uint32_t index) {
+        auto &player = players_[index];
+        while (player.fd >= 0) {
+            const auto received = recv(player.fd, player.input.data() + player.input_size,
+                                       player.input.size() - player.input_size, 0);
+            if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return;
+            }
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                ++stats_.disconnects;
+                disconnect(player);
+                return;
+            }
+            player.input_size += static_cast<size_t>(received);
+            if (!processFrames(index)) {
+                LOG_E("Malformed frame from server");
+                ++stats_.disconnects;
+                disconnect(player);
+                return;
+            }
+        }
+    }
+
+    bool processFrames(uint32_t index) {
+        auto &player = players_[index];
+        size_t offset = 0;
+        while (true) {
+            const auto parsed = Wire::parseFrame(
+                std::span<const uint8_t>(player.input.data() + offset, player.input_size - offset));
+            if (parsed.status == Wire::ParseStatus::kIncomplete) {
+                break;
+            }
+            if (parsed.status == Wire::ParseStatus::kMalformed) {
+                return false;
+            }
+            const auto &frame = parsed.frame;
+            offset += frame.size();
+            switch (frame.type) {
+                case Wire::MessageType::Hello:
+                    player.player_type = Wire::HelloMessage{frame.payload}.player_type();
+                    break;
+                case Wire::MessageType::MoveRequest:
+                    onAnswer(player);
+                    onMoveRequest(index, Wire::MoveRequestMessage{frame.payload}.board());
+                    break;
+                case Wire::MessageType::RoundEnd:
+                    onAnswer(player);
+                    ++stats_.rounds;
+                    break;
+                default:
+                    break;
+            }
+        }
+        std::memmove(player.input.data(), player.input.data() + offset, player.input_size - offset);
+        player.input_size -= offset;
+        return true;
+    }
+
+    void onAnswer(SimulatedPlayer &player) {
+        if (player.move_sent.has_value()) {
+            rtt_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - *player.move_sent).count()));
+            player.move_sent.reset();
+        }
+    }
+
+    void onMoveRequest(uint32_t index, const Board::BoardType &board) {
+        auto &player = players_[index];
+        const auto moves = Board::legalMoves(board);
+        if (moves.empty()) {
+            return;
+        }
+        player.next_move = moves[Random::uniform(gen_, static_cast<uint32_t>(moves.size))];
+        auto think_time = config_.think_time;
+        if (config_.think_jitter.count() > 0) {
+            think_time += std::chrono::milliseconds(
+                Random::uniform(gen_, static_cast<uint32_t>(config_.think_jitter.count()) + 1U));
+        }
+        if (think_time.count() == 0) {
+            sendMove(player);
+        } else {
+            timers_.emplace(Clock::now() + think_time, index);
+        }
+    }
+
+    void sendDueMoves(Clock::time_point now) {
+        while (!timers_.empty() && timers_.top().first <= now) {
+            auto &player = players_[timers_.top().second];
+            timers_.pop();
+            if (player.fd >= 0) {
+                sendMove(player);
+            }
+        }
+    }
+
+    void sendMove(SimulatedPlayer &player) {
+        std::array<uint8_t, Wire::frameSize(Wire::MessageType::Move)> frame {};
+        Wire::encodeMove(frame.data(), player.next_move);
+        player.move_sent = Clock::now();
+        // The server reads every move before asking for the next one, so the socket buffer never fills
+        if (send(player.fd, frame.data(), frame.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(frame.size())) {
+            ++stats_.disconnects;
+            disconnect(player);
+            return;
+        }
+        ++stats_.moves;
+    }
+};
+
+// Thousands of sockets need more than the usual soft limit of 1024 descriptors
+void raiseDescriptorLimit() {
+    rlimit limit {};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int runLoad(const LoadConfig &config) {
+    raiseDescriptorLimit();
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    for (size_t i = 0; i < config.threads; ++i) {
+        const auto share = config.connections / config.threads + (i < config.connections % config.threads ? 1U : 0U);
+        workers.push_back(std::make_unique<LoadWorker>(config, share, Random::deriveSeed(config.seed, i)));
+    }
+
+    const auto start = Clock::now();
+    const auto end = start + config.duration;
+    {
+        std::vector<std::jthread> threads;
+        for (auto &worker : workers) {
+            threads.emplace_back([&worker, end]() {
+                worker->run(end);
+            });
+        }
+    }
+    const auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    LoadStats total;
+    Metrics::Histogram::Counts counts {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    for (const auto &worker : workers) {
+        const auto &stats = worker->stats();
+        total.connected += stats.connected;
+        total.connect_failures += stats.connect_failures;
+        total.disconnects += stats.disconnects;
+        total.moves += stats.moves;
+        total.rounds += stats.rounds;
+        worker->rtt().mergeInto(counts, count, sum);
+    }
+    const auto micros = [&](double quantile) {
+        return static_cast<double>(Metrics::Histogram::quantile(counts, count, quantile)) / 1000.0;
+    };
+
+    std::printf("connections=%zu connect_failures=%zu disconnects=%zu seconds=%.3f\n",
+                total.connected, total.connect_failures, total.disconnects, seconds);
+    std::printf("moves=%zu rounds=%zu moves_per_second=%.0f rounds_per_second=%.0f\n",
+                total.moves, total.rounds, static_cast<double>(total.moves) / seconds,
+                static_cast<double>(total.rounds) / seconds);
+    std::printf("rtt_samples=%lu rtt_mean_us=%.1f rtt_p50_us=%.1f rtt_p99_us=%.1f rtt_p999_us=%.1f\n",
+                static_cast<unsigned long>(count),
+                count == 0U ? 0.0 : static_cast<double>(sum) / static_cast<double>(count) / 1000.0,
+                micros(0.5), micros(0.99), micros(0.999));
+    return total.connect_failures == 0U ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger();
+
+    LoadConfig config;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-a") {
+                config.address = value;
+            } else if (option == "-p") {
+                config.port = static_cast<uint16_t>(std::stoul(value));
+            } else if (option == "-c") {
+                config.connections = std::stoull(value);
+            } else if (option == "-t") {
+                config.threads = std::stoull(value);
+            } else if (option == "-d") {
+                config.duration = std::chrono::seconds(std::stoull(value));
+            } else if (option == "-k") {
+                config.think_time = std::chrono::milliseconds(std::stoull(value));
+            } else if (option == "-j") {
+                config.think_jitter = std::chrono::milliseconds(std::stoull(value));
+            } else if (option == "-s") {
+                config.seed = std::stoull(value);
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+    if (config.port == 0U || config.threads == 0U || config.connections == 0U) {
+        printUsage();
+        return 1;
+    }
+    return runLoad(config);
+}
@@ -0,0 +1,105 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "perft.h"
+#include "log.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_perft [options]\n"
+              << "  -p <cells>       start position, rows top to bottom, X, O or . per cell (default empty)\n"
+              << "  -d <plies>       depth (default: until the board is full)\n"
+              << "  -t <count>       worker threads (default: hardware threads)\n"
+              << "  -H <MiB>         transposition table size, 0 disables it (default 0)\n"
+              << "  -c               check the full tree totals, exit code 1 on a mismatch\n";
+}
+
+bool parsePosition(std::string_view cells, Board::BoardType &board) {
+    if (cells.size() != Perft::kCellCount) {
+        return false;
+    }
+    for (size_t index = 0; index < cells.size(); ++index) {
+        auto &field = board[index / Board::kBoardSize][index % Board::kBoardSize];
+        switch (cells[index]) {
+            case 'X': field = Board::BoardField::X; break;
+            case 'O': field = Board::BoardField::O; break;
+            case '.': field = Board::BoardField::EMPTY; break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger();
+
+    Perft::PerftConfig config;
+    bool check = false;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (option == "-c") {
+                check = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-p") {
+                if (!parsePosition(value, config.board)) {
+                    std::cerr << "Invalid position: " << value << "\n";
+                    return 1;
+                }
+            } else if (option == "-d") {
+                config.depth = std::stoull(value);
+            } else if (option == "-t") {
+                config.threads = std::stoull(value);
+            } else if (option == "-H") {
+                config.hash_megabytes = std::stoull(value);
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+    if (check) {
+        config.board = {};
+        config.depth = Perft::kCellCount;
+    }
+
+    try {
+        Perft::Perft perft(config);
+        const auto result = perft.run();
+        for (size_t ply = 1; ply <= result.depth; ++ply) {
+            std::printf("ply=%zu nodes=%llu\n", ply, static_cast<unsigned long long>(result.nodes[ply]));
+        }
+        const auto nodes = result.totalNodes();
+        std::printf("depth=%zu threads=%zu nodes=%llu games=%llu x_wins=%llu o_wins=%llu draws=%llu hash_hits=%llu "
+                    "seconds=%.6f nodes_per_second=%.0f\n",
+                    result.depth, result.threads, static_cast<unsigned long long>(nodes),
+                    static_cast<unsigned long long>(result.games()), static_cast<unsigned long long>(result.x_wins),
+                    static_cast<unsigned long long>(result.o_wins), static_cast<unsigned long long>(result.draws),
+                    static_cast<unsigned long long>(result.hash_hits), result.seconds,
+                    result.seconds > 0.0 ? static_cast<double>(nodes) / result.seconds : 0.0);
+        if (check) {
+            const bool passed = result.games() == Perft::kFullTreeGames && nodes == Perft::kFullTreeNodes;
+            std::printf("check=%s\n", passed ? "pass" : "fail");
+            return passed ? 0 : 1;
+        }
+    } catch (const std::exception &e) {
+        LOG_E("Perft failed: {}", e.what());
+        std::cerr << "Perft failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "bot_random.h"
+#include "game_engine.h"
+#include "log.h"
+#include "player_bot.h"
+#include "player_manager.h"
+#include "remote_socket.h"
+#include "wire_protocol.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_remote_client [options]\n"
+              << "  -a <address>     server IPv4 address (default 127.0.0.1)\n"
+              << "  -p <port>        server port\n"
+              << "  -s <seed>        random bot seed (default 0)\n"
+              << "  -r <rounds>      disconnect after this many rounds (default: play until the server hangs up)\n"
+              << "  -w <session>     watch a running session as a spectator instead of playing\n"
+              << "  -l <rounds>      loopback check: serve a random bot host on 127.0.0.1 and play it\n";
+}
+
+struct ClientStats {
+    size_t moves = 0;
+    size_t rounds = 0;
+    size_t wins = 0;
+    size_t losses = 0;
+    size_t draws = 0;
+    uint32_t session = 0;
+};
+
+struct WatchStats {
+    size_t snapshots = 0;
+    size_t deltas = 0;
+    size_t rounds = 0;
+    std::pair<int, int> score = {0, 0};
+};
+
+bool sendAll(int socket_fd, const uint8_t *data, size_t size) {
+    while (size > 0U) {
+        const auto sent = send(socket_fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// Stand-in remote player, answers every move request with a random legal move until the server hangs up
+ClientStats runClient(int socket_fd, Random::Seed seed, size_t max_rounds = 0) {
+    ClientStats stats;
+    BotRandom bot(seed);
+    auto player_type = BoardPlayerType::O;
+    std::array<uint8_t, Wire::kMaxFrameSize * 16U> input {};
+    size_t input_size = 0;
+    std::array<uint8_t, Wire::kMaxFrameSize> output {};
+
+    while (max_rounds == 0U || stats.rounds < max_rounds) {
+        const auto received = recv(socket_fd, input.data() + input_size, input.size() - input_size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+        input_size += static_cast<size_t>(received);
+
+        size_t offset = 0;
+        while (true) {
+            const auto parsed = Wire::parseFrame(std::span<const uint8_t>(input.data() + offset, input_size - offset));
+            if (parsed.status == Wire::ParseStatus::kIncomplete) {
+                break;
+            }
+            if (parsed.status == Wire::ParseStatus::kMalformed) {
+                LOG_E("Malformed frame from server");
+                return stats;
+            }
+            const auto &frame = parsed.frame;
+            offset += frame.size();
+            switch (frame.type) {
+                case Wire::MessageType::Hello: {
+                    const Wire::HelloMessage hello{frame.payload};
+                    player_type = hello.player_type();
+                    stats.session = hello.session();
+                    break;
+                }
+                case Wire::MessageType::MoveRequest: {
+                    const auto board = Wire::MoveRequestMessage{frame.payload}.board();
+                    const auto move = bot.getMove(Board::BoardView(board), player_type, {});
+                    const auto size = Wire::encodeMove(output.data(), move);
+                    if (!sendAll(socket_fd, output.data(), size)) {
+                        return stats;
+                    }
+                    ++stats.moves;
+                    break;
+                }
+                case Wire::MessageType::RoundEnd: {
+                    auto result = Wire::RoundEndMessage{frame.payload}.result();
+                    ++stats.rounds;
+                    // Our own side, the client is the guest only when it was told to play O
+                    if (player_type == BoardPlayerType::X && result != RoundResult::Draw) {
+                        result = result == RoundResult::HostWin ? RoundResult::GuestWin : RoundResult::HostWin;
+                    }
+                    if (result == RoundResult::Draw) {
+                        ++stats.draws;
+                    } else if (result == RoundResult::GuestWin) {
+                        ++stats.wins;
+                    } else {
+                        ++stats.losses;
+                    }
+                    break;
+                }
+                default:
+                    // Score and final board of the round are not needed by the bot
+                    break;
+            }
+        }
+        std::memmove(input.data(), input.data() + offset, input_size - offset);
+        input_size -= offset;
+    }
+    return stats;
+}
+
+// Spectates a session until the server hangs up or max_rounds rounds ended
+WatchStats runWatcher(int socket_fd, uint32_t session, size_t max_rounds) {
+    WatchStats stats;
+    std::array<uint8_t, Wire::kMaxFrameSize * 64U> input {};
+    size_t input_size = Wire::encodeWatch(input.data(), session);
+    if (!sendAll(socket_fd, input.data(), input_size)) {
+        return stats;
+    }
+    input_size = 0;
+
+    while (max_rounds == 0U || stats.rounds < max_rounds) {
+        const auto received = recv(socket_fd, input.data() + input_size, input.size() - input_size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            break;
+        }
+        input_size += static_cast<size_t>(received);
+
+        size_t offset = 0;
+        while (true) {
+            const auto parsed = Wire::parseFrame(std::span<const uint8_t>(input.data() + offset, input_size - offset));
+            if (parsed.status == Wire::ParseStatus::kIncomplete) {
+                break;
+            }
+            if (parsed.status == Wire::ParseStatus::kMalformed) {
+                LOG_E("Malformed frame from server");
+                return stats;
+            }
+            const auto &frame = parsed.frame;
+            offset += frame.size();
+            switch (frame.type) {
+                case Wire::MessageType::BoardState:
+                    ++stats.snapshots;
+                    break;
+                case Wire::MessageType::BoardDelta:
+                    ++stats.deltas;
+                    break;
+                case Wire::MessageType::RoundEnd:
+                    ++stats.rounds;
+                    break;
+                case Wire::MessageType::Score:
+                    stats.score = Wire::ScoreMessage{frame.payload}.score();
+                    break;
+                default:
+                    break;
+            }
+        }
+        std::memmove(input.data(), input.data() + offset, input_size - offset);
+        input_size -= offset;
+    }
+    return stats;
+}
+
+void printClientStats(const ClientStats &stats) {
+    std::printf("client_session=%u client_moves=%zu client_rounds=%zu client_wins=%zu client_losses=%zu "
+                "client_draws=%zu\n",
+                stats.session, stats.moves, stats.rounds, stats.wins, stats.losses, stats.draws);
+}
+
+// Hosts a random bot against a PlayerRemote guest over loopback, the guest is runClient() on another thread
+int runLoopback(size_t rounds, Random::Seed seed) {
+    const int listen_fd = Remote::listenTcp("127.0.0.1", 0);
+    const auto port = Remote::localPort(listen_fd);
+
+    ClientStats client_stats;
+    std::thread client([&client_stats, port, seed]() {
+        const int socket_fd = Remote::connectTcp("127.0.0.1", port);
+        client_stats = runClient(socket_fd, seed);
+        close(socket_fd);
+    });
+
+    const int socket_fd = Remote::acceptTcp(listen_fd);
+    close(listen_fd);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::pair<int, int> score;
+    size_t moves = 0;
+    {
+        auto host = std::make_shared<Player::PlayerBot>(BoardPlayerType::X, std::make_unique<BotFactoryRandom>(),
+                                                        Random::deriveSeed(seed, 1U));
+        auto player_manager = std::make_shared<PlayerManager::PlayerManager>(PlayerManager::TypeOfGuestPlayer::Remote,
+                                                                              host, socket_fd);
+        GameEngine::GameEngine game_engine(player_manager, Board::kBoardSize);
+        std::pair<int, int> last_score = {0, 0};
+        while (game_engine.getRoundsPlayed() < rounds) {
+            const auto result = game_engine.processGame({});
+            if (result == GameEngine::GameEngineError::kOK) {
+                ++moves;
+            } else if (result == GameEngine::GameEngineError::kGameFinished) {
+                ++moves;
+                score = game_engine.getScore();
+                auto round_result = RoundResult::Draw;
+                if (score.first > last_score.first) {
+                    round_result = RoundResult::HostWin;
+                } else if (score.second > last_score.second) {
+                    round_result = RoundResult::GuestWin;
+                }
+                last_score = score;
+                player_manager->notifyPlayersRoundEnd(round_result, score, game_engine.getRoundsPlayed(),
+                                                      game_engine.getBoard());
+                game_engine.resetGame();
+            }
+        }
+        // Closing the remote player's socket ends the client
+    }
+    client.join();
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("rounds=%zu moves=%zu host_score=%d guest_score=%d seconds=%.3f moves_per_second=%.0f\n",
+                rounds, moves, score.first, score.second, seconds, static_cast<double>(moves) / seconds);
+    printClientStats(client_stats);
+    return client_stats.rounds == rounds ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger();
+
+    std::string address = "127.0.0.1";
+    uint16_t port = 0;
+    Random::Seed seed = 0;
+    size_t loopback_rounds = 0;
+    size_t max_rounds = 0;
+    std::optional<uint32_t> watch_session;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-a") {
+                address = value;
+            } else if (option == "-p") {
+                port = static_cast<uint16_t>(std::stoul(value));
+            } else if (option == "-s") {
+                seed = std::stoull(value);
+            } else if (option == "-r") {
+                max_rounds = std::stoull(value);
+            } else if (option == "-w") {
+                watch_session = static_cast<uint32_t>(std::stoul(value));
+            } else if (option == "-l") {
+                loopback_rounds = std::stoull(value);
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+    if (loopback_rounds == 0U && port == 0U) {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        if (loopback_rounds > 0U) {
+            return runLoopback(loopback_rounds, seed);
+        }
+        const int socket_fd = Remote::connectTcp(address, port);
+        if (watch_session.has_value()) {
+            const auto stats = runWatcher(socket_fd, *watch_session, max_rounds);
+            close(socket_fd);
+            std::printf("watch_snapshots=%zu watch_deltas=%zu watch_rounds=%zu host_score=%d guest_score=%d\n",
+                        stats.snapshots, stats.deltas, stats.rounds, stats.score.first, stats.score.second);
+            return 0;
+        }
+        std::array<uint8_t, Wire::frameSize(Wire::MessageType::Join)> join {};
+        Wire::encodeJoin(join.data());
+        if (!sendAll(socket_fd, join.data(), join.size())) {
+            close(socket_fd);
+            throw std::runtime_error("Cannot send Join");
+        }
+        const auto stats = runClient(socket_fd, seed, max_rounds);
+        close(socket_fd);
+        printClientStats(stats);
+    } catch (const std::exception &e) {
+        LOG_E("Remote client failed: {}", e.what());
+        std::cerr << "Remote client failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "self_play.h"
+#include "log.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_selfplay -o <dataset> [options]\n"
+              << "  -o <path>        output dataset file\n"
+              << "  -p <host:guest>  bot pairing, bots: random, algorithm (repeatable, default random:random)\n"
+              << "  -g <count>       games per pairing (default 1000)\n"
+              << "  -t <count>       worker threads (default: hardware threads)\n"
+              << "  -s <seed>        master seed (default 0)\n"
+              << "  -c <count>       samples per chunk (default 65536)\n";
+}
+
+bool parseBotKind(std::string_view name, SelfPlay::BotKind &kind) {
+    if (name == "random") {
+        kind = SelfPlay::BotKind::Random;
+    } else if (name == "algorithm") {
+        kind = SelfPlay::BotKind::Algorithm;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parsePairing(std::string_view text, SelfPlay::Pairing &pairing) {
+    const auto separator = text.find(':');
+    if (separator == std::string_view::npos) {
+        return false;
+    }
+    return parseBotKind(text.substr(0, separator), pairing.host) &&
+           parseBotKind(text.substr(separator + 1), pairing.guest);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger();
+
+    SelfPlay::SelfPlayConfig config;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-o") {
+                config.output_path = value;
+            } else if (option == "-p") {
+                SelfPlay::Pairing pairing {};
+                if (!parsePairing(value, pairing)) {
+                    std::cerr << "Invalid pairing: " << value << "\n";
+                    return 1;
+                }
+                config.pairings.push_back(pairing);
+            } else if (option == "-g") {
+                config.games_per_pairing = std::stoull(value);
+            } else if (option == "-t") {
+                config.threads = std::stoull(value);
+            } else if (option == "-s") {
+                config.seed = std::stoull(value);
+            } else if (option == "-c") {
+                config.chunk_capacity = std::stoull(value);
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+    if (config.output_path.empty()) {
+        printUsage();
+        return 1;
+    }
+    if (config.pairings.empty()) {
+        config.pairings.push_back({SelfPlay::BotKind::Random, SelfPlay::BotKind::Random});
+    }
+
+    try {
+        SelfPlay::SelfPlayPipeline pipeline(config);
+        const auto stats = pipeline.run();
+        std::cout << "games=" << stats.games << " samples=" << stats.samples << " chunks=" << stats.chunks
+                  << " seconds=" << stats.seconds
+                  << " samples_per_second=" << (stats.seconds > 0.0 ? stats.samples / stats.seconds : 0.0) << "\n";
+    } catch (const std::exception &e) {
+        LOG_E("Self-play failed: {}", e.what());
+        std::cerr << "Self-play failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "evaluator.h"
+#include "tournament.h"
+#include "log.h"
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: tictactoe_tournament -e <bot>[:name] -e <bot>[:name] [options]\n"
+              << "  -e <bot>[:name]  entrant, bots: random, algorithm, evaluator (repeatable, at least two)\n"
+              << "  -g <count>       games per pair (default 100)\n"
+              << "  -t <count>       worker threads (default: hardware threads)\n"
+              << "  -s <seed>        master seed (default 0)\n"
+              << "  -w <path>        evaluator weights file (default: built-in weights)\n"
+              << "  -d <depth>       evaluator search depth (default " << BotEvaluator::kDefaultDepth << ")\n"
+              << "  -o <path>        write the evaluator weights in use to a file\n";
+}
+
+// Network and depth of all evaluator entrants
+struct EvaluatorOptions {
+    std::shared_ptr<const Eval::Network> network;
+    size_t depth = BotEvaluator::kDefaultDepth;
+};
+
+bool parseEntrant(std::string_view text, const EvaluatorOptions &evaluator, Tournament::Entrant &entrant) {
+    const auto separator = text.find(':');
+    const auto kind = text.substr(0, separator);
+    entrant.name = std::string(separator == std::string_view::npos ? kind : text.substr(separator + 1));
+    if (kind == "random") {
+        entrant.create_factory = []() -> std::unique_ptr<IBotFactory> {
+            return std::make_unique<BotFactoryRandom>();
+        };
+    } else if (kind == "algorithm") {
+        entrant.create_factory = []() -> std::unique_ptr<IBotFactory> {
+            return std::make_unique<BotFactoryAlgorithm>();
+        };
+    } else if (kind == "evaluator") {
+        entrant.create_factory = [evaluator]() -> std::unique_ptr<IBotFactory> {
+            return std::make_unique<BotFactoryEvaluator>(evaluator.network, evaluator.depth);
+        };
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    init_logger();
+
+    Tournament::TournamentConfig config;
+    // Entrants are created once the weights are known, -w may follow -e
+    std::vector<std::string> entrants;
+    std::string weights_path;
+    std::string weights_output;
+    EvaluatorOptions evaluator;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view option = argv[i];
+            if (i + 1 >= argc) {
+                printUsage();
+                return 1;
+            }
+            const std::string value = argv[++i];
+            if (option == "-e") {
+                entrants.push_back(value);
+            } else if (option == "-g") {
+                config.games_per_pair = std::stoull(value);
+            } else if (option == "-t") {
+                config.threads = std::stoull(value);
+            } else if (option == "-s") {
+                config.seed = std::stoull(value);
+            } else if (option == "-w") {
+                weights_path = value;
+            } else if (option == "-d") {
+                evaluator.depth = std::stoull(value);
+            } else if (option == "-o") {
+                weights_output = value;
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Invalid argument: " << e.what() << "\n";
+        return 1;
+    }
+    if (entrants.size() < 2U) {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        evaluator.network = weights_path.empty() ? Eval::Network::builtIn() : Eval::Network::load(weights_path);
+        if (!weights_output.empty() && !evaluator.network->save(weights_output)) {
+            std::cerr << "Cannot write weights file " << weights_output << "\n";
+            return 1;
+        }
+        for (const auto &text : entrants) {
+            Tournament::Entrant entrant;
+            if (!parseEntrant(text, evaluator, entrant)) {
+                std::cerr << "Invalid entrant: " << text << "\n";
+                return 1;
+            }
+            config.entrants.push_back(std::move(entrant));
+        }
+        Tournament::Tournament tournament(std::move(config));
+        const auto report = tournament.run();
+        std::printf("%-16s %7s %6s %6s %6s %8s %7s %9s %14s %14s\n",
+                    "name", "games", "wins", "draws", "losses", "elo", "+/-", "moves", "mean_move_ns", "p99_move_ns");
+        for (const auto &entrant : report.entrants) {
+            std::printf("%-16s %7zu %6zu %6zu %6zu %8.1f %7.1f %9zu %14.0f %14.0f\n",
+                        entrant.name.c_str(), entrant.games, entrant.wins, entrant.draws, entrant.losses,
+                        entrant.elo, entrant.elo_error, entrant.moves, entrant.mean_move_ns, entrant.p99_move_ns);
+        }
+        std::printf("games=%zu seconds=%.3f\n", report.games, report.seconds);
+    } catch (const std::exception &e) {
+        LOG_E("Tournament failed: {}", e.what());
+        std::cerr << "Tournament failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}